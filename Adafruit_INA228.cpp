@@ -31,9 +31,11 @@
 
 #include "Adafruit_INA228.h"
 
-#include <Wire.h>
+#include "Adafruit_INA228_Calibration.h"
 
-#include "Arduino.h"
+// widths of the result registers starting at VSHUNT (0x04)
+static const uint8_t snapshot_widths[INA228_SNAPSHOT_REGISTERS] = {
+    3, 3, 2, 3, 3, 5, 5};
 
 /*!
  *    @brief  Instantiates a new INA228 class
@@ -41,56 +43,192 @@
 Adafruit_INA228::Adafruit_INA228(void) {}
 
 /*!
- *    @brief  Sets up the HW
- *    @param  i2c_address
+ *    @brief  Instantiates an idle request for readSnapshotAsync()
+ */
+INA228_AsyncSnapshot::INA228_AsyncSnapshot(void)
+    : ok(false), device(NULL), _callback(NULL), _context(NULL), _channels(0),
+      _range(0) {
+  snapshot.mask = 0;
+  _transfer.transport = NULL;
+  _transfer.pending = false;
+  _transfer.next = NULL;
+}
+
+/*!
+ *    @brief  Checks whether the request is still waiting for its callback
+ *    @return True until the callback has run
+ */
+bool INA228_AsyncSnapshot::pending(void) const {
+  return _transfer.pending;
+}
+
+#if defined(ARDUINO)
+/*!
+ *    @brief  Sets up the HW and applies a calibration worked out at compile
+ *            time, instead of calling setShunt()
+ *    @param  calibration
+ *            The calibration, see INA228_CALIBRATION
+ *    @param  i2c_addr
  *            The I2C address to be used.
  *    @param  theWire
  *            The Wire object to be used for I2C connections.
  *    @param  skipReset
- *            When set to true, will omit resetting all INA228 registers to
+ *            When set to true, will omit resetting all registers to
  *            their default values. Default: false.
- *    @return True if initialization was successful, otherwise false.
+ *    @return True if the chip was found and the calibration written
  */
-bool Adafruit_INA228::begin(uint8_t i2c_address, TwoWire* theWire,
+bool Adafruit_INA228::begin(const INA228_Calibration& calibration,
+                            uint8_t i2c_addr, TwoWire* theWire,
                             bool skipReset) {
-  if (!Adafruit_INA2xx::begin(i2c_address, theWire, skipReset)) {
+  if (!beginAsync(i2c_addr, theWire, skipReset) ||
+      !setCalibration(calibration)) {
     return false;
   }
+  return _waitForStartup();
+}
 
-  // make sure we're talking to the right chip
-  if (_device_id != INA228_DEVICE_ID) {
+/*!
+ *    @brief  Sets up the HW and applies a complete configuration. With
+ *            skipReset the chip's current state is read back first and
+ *            registers that already match are left alone, so a warm start
+ *            keeps the energy and charge accumulators running.
+ *    @param  config
+ *            The configuration to apply
+ *    @param  i2c_addr
+ *            The I2C address to be used.
+ *    @param  theWire
+ *            The Wire object to be used for I2C connections.
+ *    @param  skipReset
+ *            When set to true, will omit resetting all registers to
+ *            their default values. Default: false.
+ *    @return True if the chip was found and configured
+ */
+bool Adafruit_INA228::begin(const INA228_Config& config, uint8_t i2c_addr,
+                            TwoWire* theWire, bool skipReset) {
+  // after a reset every register is at its power-on value, no need to read
+  if (!beginAsync(i2c_addr, theWire, skipReset) ||
+      !_applyConfig(config, !skipReset)) {
     return false;
   }
-
-  return true;
+  return _waitForStartup();
 }
+#endif
 
 /**************************************************************************/
 /*!
-    @brief Resets the hardware specific to INA228
+    @brief Writes a complete configuration: CONFIG, ADC_CONFIG, SHUNT_CAL
+    and SHUNT_TEMPCO, one write each at most. The chip's state is read back
+    first (from the register cache where enabled) and registers that
+    already hold the wanted value are not written.
+    @param config
+          The configuration to apply
+    @return True if the chip was read and written successfully, false as
+    well if the shunt and current need a SHUNT_CAL out of range
 */
 /**************************************************************************/
-void Adafruit_INA228::reset(void) {
-  // Perform base class reset
-  Adafruit_INA2xx::reset();
-  // Any additional INA228 specific reset actions would go here
+bool Adafruit_INA228::applyConfig(const INA228_Config& config) {
+  return _applyConfig(config, false);
 }
 
 /**************************************************************************/
 /*!
-    @brief Updates the shunt calibration value to the INA228 register.
+    @brief Writes the registers of a configuration that differ from the
+    chip's state
+    @param config
+          The configuration to apply
+    @param from_reset
+          True if the chip was just reset, so its state is known without
+          reading it
+    @return True if the chip was read and written successfully
 */
 /**************************************************************************/
-void Adafruit_INA228::_updateShuntCalRegister() {
-  float scale = 1;
-  if (getADCRange()) {
-    scale = 4;
+bool Adafruit_INA228::_applyConfig(const INA228_Config& config,
+                                   bool from_reset) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+  static const uint8_t regs[] = {INA2XX_REG_CONFIG, INA2XX_REG_ADCCFG,
+                                 INA2XX_REG_SHUNTCAL, INA228_REG_SHUNTTEMPCO};
+  uint16_t current[] = {INA2XX_CONFIG_DEFAULT, INA2XX_ADCCFG_DEFAULT,
+                        INA2XX_SHUNTCAL_DEFAULT, 0};
+  uint16_t wanted[4];
+
+  uint8_t range = config.adc_range ? 1 : 0;
+  if (config.calibration) {
+    range = config.calibration->adc_range;
+    _shunt_res = config.calibration->shunt_res;
+    _current_lsb = config.calibration->current_lsb;
+    _current_scale = config.calibration->current_scale;
+    _power_scale = config.calibration->power_scale;
+    _energy_scale = config.calibration->energy_scale;
+    _charge_scale = config.calibration->charge_scale;
+    wanted[2] = config.calibration->shunt_cal;
+  } else {
+    _setShuntScales(config.shunt_res, config.max_current);
+    _setAccumulatorScales();
+    if (!_shuntCalFits(range)) {
+      return false;
+    }
+    wanted[2] = _shuntCalFor(range);
   }
-  float shunt_cal = 13107.2 * 1000000.0 * _shunt_res * _current_lsb * scale;
+  wanted[0] = (uint16_t)config.conversion_delay << 6 |
+              (config.temp_compensation ? 1 << 5 : 0) | range << 4;
+  wanted[1] = (uint16_t)config.mode << 12 | (config.bus_time & 0x7) << 9 |
+              (config.shunt_time & 0x7) << 6 | (config.temp_time & 0x7) << 3 |
+              (config.averaging & 0x7);
+  wanted[3] = config.shunt_tempco & 0x3FFF;
 
-  Adafruit_I2CRegister shunt =
-      Adafruit_I2CRegister(i2c_dev, INA2XX_REG_SHUNTCAL, 2, MSBFIRST);
-  shunt.write(shunt_cal);
+  for (uint8_t i = 0; i < 4; i++) {
+    if (!from_reset) {
+      uint16_t mask;
+      uint16_t* cache = _cacheFor(regs[i], &mask);
+      if (cache) {
+        current[i] = *cache;
+      } else {
+        uint8_t buff[2];
+        if (!_readRegister(regs[i], buff, 2)) {
+          return false;
+        }
+        current[i] = (uint16_t)buff[0] << 8 | buff[1];
+      }
+    }
+    // reset and reserved bits read back as 0, so a plain compare works
+    if (current[i] == wanted[i]) {
+      continue;
+    }
+    if (!_writeRegister(regs[i], wanted[i])) {
+      return false;
+    }
+  }
+  if (_startup_state == INA2XX_CONVERSION_PENDING) {
+    // the new settings restart the first conversion
+    _armStartup(wanted[0], wanted[1]);
+  }
+  return _updateLimitRegisters(range);
+}
+
+/**************************************************************************/
+/*!
+    @brief Applies a calibration worked out at compile time. Only integers
+    are copied and SHUNT_CAL is written once. CONFIG is written as well if
+    the ADC range has to change, and current and power limits set earlier
+    are rewritten for the new scaling.
+    @param calibration
+          The calibration, see INA228_CALIBRATION
+    @return True if the registers were written
+*/
+/**************************************************************************/
+bool Adafruit_INA228::setCalibration(const INA228_Calibration& calibration) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+  if (getADCRange() != calibration.adc_range) {
+    _writeRegisterBits(INA2XX_REG_CONFIG, 1, 4, calibration.adc_range);
+  }
+  _shunt_res = calibration.shunt_res;
+  _current_lsb = calibration.current_lsb;
+  _current_scale = calibration.current_scale;
+  _power_scale = calibration.power_scale;
+  _energy_scale = calibration.energy_scale;
+  _charge_scale = calibration.charge_scale;
+  return _writeRegister(INA2XX_REG_SHUNTCAL, calibration.shunt_cal) &&
+         _updateLimitRegisters(calibration.adc_range);
 }
 
 /**************************************************************************/
@@ -100,16 +238,9 @@ void Adafruit_INA228::_updateShuntCalRegister() {
 */
 /**************************************************************************/
 float Adafruit_INA228::readEnergy(void) {
-  Adafruit_I2CRegister energy =
-      Adafruit_I2CRegister(i2c_dev, INA228_REG_ENERGY, 5, MSBFIRST);
-  uint8_t buff[5];
-  energy.read(buff, 5);
-  float e = 0;
-  for (int i = 0; i < 5; i++) {
-    e *= 256;
-    e += buff[i];
-  }
-  return (float)e * 16 * 3.2 * _current_lsb;
+  INA2XX_STATS_SCOPE(INA2XX_OP_ENERGY);
+  return (float)readEnergyRaw() * 16 * INA228_Traits::powerLsbFactor() *
+         _current_lsb;
 }
 
 /**************************************************************************/
@@ -119,10 +250,38 @@ float Adafruit_INA228::readEnergy(void) {
 */
 /**************************************************************************/
 float Adafruit_INA228::readCharge(void) {
-  Adafruit_I2CRegister charge =
-      Adafruit_I2CRegister(i2c_dev, INA228_REG_CHARGE, 5, MSBFIRST);
-  uint8_t buff[5];
-  charge.read(buff, 5);
+  INA2XX_STATS_SCOPE(INA2XX_OP_CHARGE);
+  return (float)readChargeRaw() * _current_lsb;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the Energy register
+    @return The full 40-bit energy count
+*/
+/**************************************************************************/
+uint64_t Adafruit_INA228::readEnergyRaw(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_ENERGY);
+  uint8_t buff[INA228_EnergyReg::width] = {0, 0, 0, 0, 0};
+  _read<INA228_EnergyReg>(buff);
+
+  uint64_t e = 0;
+  for (int i = 0; i < 5; i++) {
+    e = (e << 8) | buff[i];
+  }
+  return e;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the Charge register
+    @return The sign extended 40-bit charge count
+*/
+/**************************************************************************/
+int64_t Adafruit_INA228::readChargeRaw(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CHARGE);
+  uint8_t buff[INA228_ChargeReg::width] = {0, 0, 0, 0, 0};
+  _read<INA228_ChargeReg>(buff);
 
   // Convert 40-bit two's complement value
   int64_t c = 0;
@@ -134,84 +293,338 @@ float Adafruit_INA228::readCharge(void) {
   if (c & ((int64_t)1 << 39)) {
     c |= 0xFFFFFF0000000000; // Sign extend to 64 bits
   }
+  return c;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the energy using the fixed-point scale set by setShunt
+    @return The current Energy calculation in uJ
+*/
+/**************************************************************************/
+int64_t Adafruit_INA228::readEnergy_uJ(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_ENERGY);
+  return energyToMicrojoules(readEnergyRaw());
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the charge using the fixed-point scale set by setShunt
+    @return The current Charge calculation in uC
+*/
+/**************************************************************************/
+int64_t Adafruit_INA228::readCharge_uC(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CHARGE);
+  return chargeToMicrocoulombs(readChargeRaw());
+}
+
+/**************************************************************************/
+/*!
+    @brief Converts an energy count to uJ with the current calibration
+    @param energy_raw
+          Energy count, either from the register or a host-side total
+    @return The energy in uJ
+*/
+/**************************************************************************/
+int64_t Adafruit_INA228::energyToMicrojoules(int64_t energy_raw) {
+  return _applyScale(energy_raw, _energy_scale);
+}
 
-  return (float)c * _current_lsb;
+/**************************************************************************/
+/*!
+    @brief Converts a charge count to uC with the current calibration
+    @param charge_raw
+          Charge count, either from the register or a host-side total
+    @return The charge in uC
+*/
+/**************************************************************************/
+int64_t Adafruit_INA228::chargeToMicrocoulombs(int64_t charge_raw) {
+  return _applyScale(charge_raw, _charge_scale);
 }
 
 /**************************************************************************/
 /*!
     @brief Returns the current alert type
-    @return The current alert type
+    @return INA228_ALERT_CONVERSION_READY if the ALERT pin follows the
+    conversion ready flag, INA228_ALERT_NONE otherwise
 */
 /**************************************************************************/
 INA228_AlertType Adafruit_INA228::getAlertType(void) {
-  Adafruit_I2CRegisterBits alert_type =
-      Adafruit_I2CRegisterBits(Diag_Alert, 6, 8);
-  return (INA228_AlertType)alert_type.read();
+  if (_readRegisterBits(INA2XX_REG_DIAGALRT, 1, 14)) {
+    return INA228_ALERT_CONVERSION_READY;
+  }
+  return INA228_ALERT_NONE;
 }
 
 /**************************************************************************/
 /*!
     @brief Sets a new alert type
+    @note On the INA228 only the conversion ready alert (CNVR) can be
+    switched on and off. The limit alerts are always armed and are set up
+    with the limit setters, such as setPowerLimit() or
+    setOvercurrentLimit(), so the INA228_ALERT_OVERPOWER to
+    INA228_ALERT_OVERCURRENT values are refused here.
     @param alert
-           The new alert type to be set
+           INA228_ALERT_CONVERSION_READY or INA228_ALERT_NONE
+    @return True if CNVR was written, false if it wasn't or the alert type
+    can't be selected
 */
 /**************************************************************************/
-void Adafruit_INA228::setAlertType(INA228_AlertType alert) {
-  Adafruit_I2CRegisterBits alert_type =
-      Adafruit_I2CRegisterBits(Diag_Alert, 6, 8);
-  alert_type.write(alert);
+bool Adafruit_INA228::setAlertType(INA228_AlertType alert) {
+  if (alert & ~INA228_ALERT_CONVERSION_READY) {
+    return false;
+  }
+  return _writeRegisterBits(INA2XX_REG_DIAGALRT, 1, 14, alert ? 1 : 0);
 }
 
 /**************************************************************************/
 /*!
     @brief Resets the energy and charge accumulators
+    @return True if RSTACC was written
 */
 /**************************************************************************/
-void Adafruit_INA228::resetAccumulators(void) {
-  Adafruit_I2CRegisterBits reset_accumulators =
-      Adafruit_I2CRegisterBits(Config, 1, 14);
-  reset_accumulators.write(1);
+bool Adafruit_INA228::resetAccumulators(void) {
+  return _writeRegisterBits(INA2XX_REG_CONFIG, 1, 14, 1);
 }
 
 /**************************************************************************/
 /*!
-    @brief Reads the die temperature with the INA228-specific conversion factor
-    @return The current die temp in deg C
+    @brief Sets the shunt calibration by resistor for INA228.
+    @param shunt_res Resistance of the shunt in ohms (floating point)
+    @param max_current Maximum expected current in A (floating point)
+    @return True if SHUNT_CAL was written and fits its field, false if the
+    write failed or the shunt and current need a value out of range
 */
 /**************************************************************************/
-float Adafruit_INA228::readDieTemp(void) {
-  Adafruit_I2CRegister temp =
-      Adafruit_I2CRegister(i2c_dev, INA2XX_REG_DIETEMP, 2, MSBFIRST);
-  int16_t t = temp.read();
-  // INA228 uses 16 bits for temperature with 7.8125 m°C/LSB
-  return (float)t * 7.8125 / 1000.0;
+bool Adafruit_INA228::setShunt(float shunt_res, float max_current) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+  bool ok =
+      Adafruit_INA2xx_Chip<INA228_Traits>::setShunt(shunt_res, max_current);
+  _setAccumulatorScales();
+  return ok;
 }
 
 /**************************************************************************/
 /*!
-    @brief Reads and scales the current value of the Bus Voltage register
-           using INA228-specific conversion factor.
-    @return The current bus voltage measurement in V
+    @brief Sets the energy and charge scales from the current LSB
 */
 /**************************************************************************/
-float Adafruit_INA228::readBusVoltage(void) {
-  Adafruit_I2CRegister bus_voltage =
-      Adafruit_I2CRegister(i2c_dev, INA2XX_REG_VBUS, 3, MSBFIRST);
-  // INA228 uses 195.3125 µV/LSB for bus voltage
-  return (float)((uint32_t)bus_voltage.read() >> 4) * 195.3125 / 1e6;
+void Adafruit_INA228::_setAccumulatorScales(void) {
+  // ENERGY is 16 x the power LSB, CHARGE is one current LSB
+  _energy_scale =
+      _makeScale(16 * INA228_Traits::powerLsbFactor() * _current_lsb * 1e6);
+  _charge_scale = _makeScale(_current_lsb * 1e6);
 }
 
 /**************************************************************************/
 /*!
-    @brief Sets the shunt calibration by resistor for INA228.
-    @param shunt_res Resistance of the shunt in ohms (floating point)
-    @param max_current Maximum expected current in A (floating point)
+    @brief Reads several result registers back to back and scales them.
+    Each register costs a single pointer write plus read, and the shunt
+    range is looked up once for the whole snapshot.
+    @param snapshot
+          Struct to fill with the raw and scaled readings
+    @param channels
+          INA228_Channel bits selecting the registers to read
+    @return True if all selected registers were read successfully
+*/
+/**************************************************************************/
+bool Adafruit_INA228::readSnapshot(INA228_Snapshot& snapshot,
+                                   uint8_t channels) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_SNAPSHOT);
+  uint8_t buffers[INA228_SNAPSHOT_REGISTERS][INA228_SNAPSHOT_WIDTH];
+  INA2xx_RegisterRead reads[INA228_SNAPSHOT_REGISTERS];
+
+  snapshot.mask = 0;
+  snapshot.timestamp_us = micros();
+  uint8_t count = _snapshotReads(reads, buffers, channels);
+  // one batch, so transports that queue transfers need a single call
+  if (!_readRegisters(reads, count)) {
+    return false;
+  }
+  _decodeSnapshot(snapshot, channels, buffers,
+                  (channels & INA228_CHANNEL_SHUNT_VOLTAGE) ? getADCRange()
+                                                            : 0);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Starts reading a snapshot and returns without waiting. The
+    register reads are queued on the transport, through the scheduler if
+    one is set, and the callback gets the decoded readings once they are
+    done. With the register cache enabled nothing blocks on the bus here.
+    @param request
+          Storage for the transfer and the result. It must stay alive and
+          not be reused until the callback has run.
+    @param channels
+          INA228_Channel bits selecting the registers to read
+    @param callback
+          Called once with the request, from the transport's completion
+          or from the scheduler's poll()
+    @param context
+          Passed to the callback untouched
+    @return True if the reads were started or queued, false if the
+    request is still pending or the transport turned it down
+*/
+/**************************************************************************/
+bool Adafruit_INA228::readSnapshotAsync(INA228_AsyncSnapshot& request,
+                                        uint8_t channels,
+                                        INA228_SnapshotCallback callback,
+                                        void* context) {
+  if (request.pending() || !callback) {
+    return false;
+  }
+  request.device = this;
+  request.ok = false;
+  request.snapshot.mask = 0;
+  request.snapshot.timestamp_us = micros();
+  request._callback = callback;
+  request._context = context;
+  request._channels = channels;
+  // looked up now, so decoding never needs the bus
+  request._range =
+      (channels & INA228_CHANNEL_SHUNT_VOLTAGE) ? getADCRange() : 0;
+  request._transfer.reads = request._reads;
+  request._transfer.count =
+      _snapshotReads(request._reads, request._buffers, channels);
+  request._transfer.done = _snapshotDone;
+  request._transfer.context = &request;
+  return _startTransfer(&request._transfer);
+}
+
+/**************************************************************************/
+/*!
+    @brief Works out how many snapshots per second can be had. A new
+    result comes every conversionPeriodMicros(), and reading the registers
+    takes the modelled bus time at busClock(). CPU time is not counted.
+    @param channels
+          INA228_Channel bits selecting the registers read per sample
+    @return Samples per second, limited by whichever of the two is slower
+*/
+/**************************************************************************/
+float Adafruit_INA228::achievableSampleRate(uint8_t channels) {
+  uint8_t buffers[INA228_SNAPSHOT_REGISTERS][INA228_SNAPSHOT_WIDTH];
+  INA2xx_RegisterRead reads[INA228_SNAPSHOT_REGISTERS];
+  uint8_t count = _snapshotReads(reads, buffers, channels);
+
+  uint32_t period = INA2xx_Transport::readMicros(reads, count, busClock());
+  uint32_t conversion = conversionPeriodMicros();
+  if (conversion > period) {
+    period = conversion;
+  }
+  return period ? 1e6f / period : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief Completion of readSnapshotAsync(): decodes the registers and
+    hands the request to its callback
+    @param transfer
+          The finished transfer, its context is the request
+*/
+/**************************************************************************/
+void Adafruit_INA228::_snapshotDone(INA2xx_Transfer* transfer) {
+  INA228_AsyncSnapshot* request = (INA228_AsyncSnapshot*)transfer->context;
+  request->ok = transfer->ok;
+  if (transfer->ok) {
+    request->device->_decodeSnapshot(request->snapshot, request->_channels,
+                                     request->_buffers, request->_range);
+  }
+  request->_callback(*request, request->_context);
+}
+
+/**************************************************************************/
+/*!
+    @brief Lists the result registers a snapshot reads
+    @param reads
+          Filled with one entry per selected register
+    @param buffers
+          One buffer per result register, indexed by channel bit
+    @param channels
+          INA228_Channel bits selecting the registers to read
+    @return Number of entries filled in
 */
 /**************************************************************************/
-void Adafruit_INA228::setShunt(float shunt_res, float max_current) {
-  _shunt_res = shunt_res;
-  // INA228 uses 2^19 as the divisor
-  _current_lsb = max_current / (float)(1UL << 19);
-  _updateShuntCalRegister();
-}
\ No newline at end of file
+uint8_t Adafruit_INA228::_snapshotReads(
+    INA2xx_RegisterRead* reads,
+    uint8_t (*buffers)[INA228_SNAPSHOT_WIDTH], uint8_t channels) {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < INA228_SNAPSHOT_REGISTERS; i++) {
+    if (channels & (1 << i)) {
+      reads[count].reg = INA2XX_REG_VSHUNT + i;
+      reads[count].len = snapshot_widths[i];
+      reads[count].buffer = buffers[i];
+      count++;
+    }
+  }
+  return count;
+}
+
+/**************************************************************************/
+/*!
+    @brief Decodes and scales the registers of a snapshot
+    @param snapshot
+          Struct to fill with the raw and scaled readings
+    @param channels
+          INA228_Channel bits that were read
+    @param buffers
+          The register bytes, indexed by channel bit
+    @param range
+          The shunt ADC range the readings were taken in
+*/
+/**************************************************************************/
+void Adafruit_INA228::_decodeSnapshot(
+    INA228_Snapshot& snapshot, uint8_t channels,
+    const uint8_t (*buffers)[INA228_SNAPSHOT_WIDTH], uint8_t range) {
+  for (uint8_t i = 0; i < INA228_SNAPSHOT_REGISTERS; i++) {
+    if (!(channels & (1 << i))) {
+      continue;
+    }
+    const uint8_t* buff = buffers[i];
+
+    uint64_t raw = 0;
+    for (uint8_t b = 0; b < snapshot_widths[i]; b++) {
+      raw = (raw << 8) | buff[b];
+    }
+    switch (1 << i) {
+    case INA228_CHANNEL_SHUNT_VOLTAGE:
+      snapshot.shunt_voltage_raw = _decodeSigned20(buff);
+      snapshot.shunt_voltage_mV =
+          (float)snapshot.shunt_voltage_raw * _shuntVoltageLsb_mV(range);
+      break;
+    case INA228_CHANNEL_BUS_VOLTAGE:
+      snapshot.bus_voltage_raw = _decodeUnsigned20(buff);
+      snapshot.bus_voltage_V =
+          (float)snapshot.bus_voltage_raw * _busVoltageLsb_V();
+      break;
+    case INA228_CHANNEL_DIE_TEMP:
+      snapshot.die_temp_raw = (int16_t)raw;
+      snapshot.die_temp_C = (float)snapshot.die_temp_raw * _dieTempLsb_C();
+      break;
+    case INA228_CHANNEL_CURRENT:
+      snapshot.current_raw = _decodeSigned20(buff);
+      snapshot.current_mA = (float)snapshot.current_raw * _current_lsb * 1000.0;
+      break;
+    case INA228_CHANNEL_POWER:
+      snapshot.power_raw = raw;
+      snapshot.power_mW =
+          (float)raw * INA228_Traits::powerLsbFactor() * _current_lsb * 1000;
+      break;
+    case INA228_CHANNEL_ENERGY:
+      snapshot.energy_raw = raw;
+      snapshot.energy_J =
+          (float)raw * 16 * INA228_Traits::powerLsbFactor() * _current_lsb;
+      break;
+    case INA228_CHANNEL_CHARGE: {
+      int64_t c = raw;
+      if (c & ((int64_t)1 << 39)) {
+        c |= 0xFFFFFF0000000000; // Sign extend to 64 bits
+      }
+      snapshot.charge_raw = c;
+      snapshot.charge_C = (float)c * _current_lsb;
+      break;
+    }
+    }
+    snapshot.mask |= 1 << i;
+  }
+}
@@ -17,7 +17,7 @@
 #ifndef _ADAFRUIT_INA228_H
 #define _ADAFRUIT_INA228_H
 
-#include "Adafruit_INA2xx.h"
+#include "Adafruit_INA2xx_Chip.h"
 
 #define INA228_I2CADDR_DEFAULT 0x40 ///< INA228 default i2c address
 #define INA228_DEVICE_ID 0x228      ///< INA228 device ID
@@ -27,6 +27,11 @@
 #define INA228_REG_CHARGE 0x0A      ///< Charge result register (40-bit)
 #define INA228_REG_SHUNTTEMPCO 0x03 ///< Shunt temperature coefficient register
 
+typedef INA2XX_Register<INA228_REG_ENERGY, 5>
+    INA228_EnergyReg; ///< Energy accumulator, 40-bit
+typedef INA2XX_Register<INA228_REG_CHARGE, 5>
+    INA228_ChargeReg; ///< Charge accumulator, 40-bit
+
 ///@{
 /**
  * @name Legacy compatibility macros
@@ -124,44 +129,262 @@ typedef INA2XX_AlertLatch INA228_AlertLatch; ///< Alias for INA2XX_AlertLatch
 /**
  * @brief Alert trigger options specific to INA228.
  *
- * Allowed values for setAlertType.
+ * Allowed values for setAlertType. Only INA228_ALERT_CONVERSION_READY and
+ * INA228_ALERT_NONE can be selected: the limit alerts have no enable bit on
+ * the INA228, they are armed by setting their limit with setPowerLimit(),
+ * setBusOvervoltageLimit(), setBusUndervoltageLimit(),
+ * setOvercurrentLimit() or setUndercurrentLimit(). setAlertType() refuses
+ * the other values.
  */
 typedef enum _alert_type {
   INA228_ALERT_CONVERSION_READY = 0x1, ///< Trigger on conversion ready
-  INA228_ALERT_OVERPOWER = 0x2,        ///< Trigger on power over limit
-  INA228_ALERT_UNDERVOLTAGE = 0x4,     ///< Trigger on bus voltage under limit
-  INA228_ALERT_OVERVOLTAGE = 0x8,      ///< Trigger on bus voltage over limit
-  INA228_ALERT_UNDERCURRENT = 0x10,    ///< Trigger on current under limit
-  INA228_ALERT_OVERCURRENT = 0x20,     ///< Trigger on current over limit
+  INA228_ALERT_OVERPOWER = 0x2,        ///< Not selectable, see setPowerLimit
+  INA228_ALERT_UNDERVOLTAGE = 0x4,     ///< Not selectable, see BUVL limit
+  INA228_ALERT_OVERVOLTAGE = 0x8,      ///< Not selectable, see BOVL limit
+  INA228_ALERT_UNDERCURRENT = 0x10,    ///< Not selectable, see SUVL limit
+  INA228_ALERT_OVERCURRENT = 0x20,     ///< Not selectable, see SOVL limit
   INA228_ALERT_NONE = 0x0,             ///< Do not trigger alert pin (Default)
 } INA228_AlertType;
 
+/**
+ * @brief Measurement channels for readSnapshot.
+ *
+ * Bit n selects result register 0x04 + n, values can be OR'ed together.
+ */
+typedef enum _channel {
+  INA228_CHANNEL_SHUNT_VOLTAGE = 0x01, ///< VSHUNT register
+  INA228_CHANNEL_BUS_VOLTAGE = 0x02,   ///< VBUS register
+  INA228_CHANNEL_DIE_TEMP = 0x04,      ///< DIETEMP register
+  INA228_CHANNEL_CURRENT = 0x08,       ///< CURRENT register
+  INA228_CHANNEL_POWER = 0x10,         ///< POWER register
+  INA228_CHANNEL_ENERGY = 0x20,        ///< ENERGY register
+  INA228_CHANNEL_CHARGE = 0x40,        ///< CHARGE register
+  INA228_CHANNEL_ALL = 0x7F,           ///< All result registers (Default)
+} INA228_Channel;
+
+/**
+ * @brief One set of readings taken back to back by readSnapshot.
+ *
+ * Only the channels listed in mask are valid. Raw values are the register
+ * contents with the reserved low bits dropped and the sign extended.
+ */
+typedef struct {
+  int64_t charge_raw;        ///< CHARGE, 40-bit two's complement
+  uint64_t energy_raw;       ///< ENERGY, 40-bit unsigned
+  uint32_t timestamp_us;     ///< micros() when the read started
+  int32_t shunt_voltage_raw; ///< VSHUNT, 20-bit two's complement
+  uint32_t bus_voltage_raw;  ///< VBUS, 20-bit unsigned
+  int32_t current_raw;       ///< CURRENT, 20-bit two's complement
+  uint32_t power_raw;        ///< POWER, 24-bit unsigned
+  float shunt_voltage_mV;    ///< Shunt voltage in mV
+  float bus_voltage_V;       ///< Bus voltage in V
+  float die_temp_C;          ///< Die temperature in deg C
+  float current_mA;          ///< Current in mA
+  float power_mW;            ///< Power in mW
+  float energy_J;            ///< Energy in Joules
+  float charge_C;            ///< Charge in Coulombs
+  int16_t die_temp_raw;      ///< DIETEMP, 16-bit two's complement
+  uint8_t mask;              ///< INA228_Channel bits that were read
+} INA228_Snapshot;
+
+#define INA228_SNAPSHOT_REGISTERS 7 ///< Result registers a snapshot can read
+#define INA228_SNAPSHOT_WIDTH 5     ///< Widest result register in bytes
+
+class Adafruit_INA228;
+class INA228_AsyncSnapshot;
+
+/// Called once a snapshot started with readSnapshotAsync has been read
+typedef void (*INA228_SnapshotCallback)(INA228_AsyncSnapshot& request,
+                                        void* context);
+
+/*!
+ *    @brief  Storage for one asynchronous snapshot: the queued transfer,
+ *            the raw register bytes and the decoded result. The caller owns
+ *            it, so the driver allocates nothing, and may reuse it once the
+ *            callback has run.
+ */
+class INA228_AsyncSnapshot {
+ public:
+  INA228_AsyncSnapshot(void);
+  bool pending(void) const;
+
+  INA228_Snapshot snapshot; ///< The readings, valid in the callback if ok
+  bool ok;                  ///< True if every register was read
+  Adafruit_INA228* device;  ///< The sensor that was read
+
+ private:
+  friend class Adafruit_INA228;
+
+  INA2xx_Transfer _transfer; ///< Queued on the transport or scheduler
+  INA2xx_RegisterRead _reads[INA228_SNAPSHOT_REGISTERS]; ///< Registers read
+  uint8_t _buffers[INA228_SNAPSHOT_REGISTERS]
+                  [INA228_SNAPSHOT_WIDTH]; ///< Raw bytes by channel bit
+  INA228_SnapshotCallback _callback;       ///< Called when done
+  void* _context;                          ///< Passed to _callback
+  uint8_t _channels;                       ///< INA228_Channel bits read
+  uint8_t _range;                          ///< Shunt ADC range when started
+};
+
+/*!
+ *    @brief  Compile-time constants of the INA228, see Adafruit_INA2xx_Chip
+ */
+struct INA228_Traits {
+  static const uint16_t device_id = INA228_DEVICE_ID; ///< DEVICE_ID field
+  static const uint8_t current_lsb_bits = 19; ///< Current LSB is max / 2^19
+  static const uint16_t shunt_lsb_nV = 625;   ///< Shunt LSB numerator in nV
+  static const uint8_t shunt_lsb_shift = 1;   ///< 312.5 nV in range 0
+  static const uint8_t shunt_lsb_shift_range1 = 3; ///< 78.125 nV in range 1
+  static const uint16_t bus_lsb_uV = 3125;         ///< Bus LSB numerator in uV
+  static const uint8_t bus_lsb_shift = 4;          ///< 195.3125 uV
+  static const uint16_t temp_lsb_mC = 125; ///< Temperature LSB numerator
+  static const uint8_t temp_lsb_shift = 4; ///< 7.8125 m°C
+  static const uint8_t shunt_cal_range1_mult = 4; ///< SHUNT_CAL x4 in range 1
+  static const uint8_t limit_shift = 4;       ///< SOVL/SUVL/BOVL LSB is 16x
+  static const uint8_t temp_limit_shift = 0;  ///< TEMP_LIMIT LSB is DIETEMP's
+  static const uint8_t power_limit_shift = 8; ///< PWR_LIMIT LSB is 256x
+  static const uint16_t bus_limit_max = 0x7FFF; ///< BOVL/BUVL are 15-bit
+  static const uint16_t shunt_cal_max = 0x7FFF; ///< SHUNT_CAL is 15-bit
+
+  /*!
+   *    @brief  SHUNT_CAL = constant x current LSB x shunt resistance
+   *    @return 13107.2 x 10^6
+   */
+  static constexpr float shuntCalConstant(void) {
+    return 13107.2e6f;
+  }
+
+  /*!
+   *    @brief  Power LSB in current LSBs
+   *    @return 3.2
+   */
+  static constexpr float powerLsbFactor(void) {
+    return 3.2f;
+  }
+
+  /*!
+   *    @brief  SHUNT_CAL before rounding. setShunt() and
+   *            INA228_Calibration both go through here, in float, so they
+   *            agree on the register value.
+   *    @param  shunt_res
+   *            Resistance of the shunt in ohms
+   *    @param  current_lsb
+   *            Current LSB in A
+   *    @param  range
+   *            Shunt ADC range, 0 or 1
+   *    @return The exact SHUNT_CAL value
+   */
+  static constexpr float shuntCal(float shunt_res, float current_lsb,
+                                  uint8_t range) {
+    return shuntCalConstant() * shunt_res * current_lsb *
+           (range ? shunt_cal_range1_mult : 1);
+  }
+
+  /*!
+   *    @brief  Rounds SHUNT_CAL to the nearest register value and clamps
+   *            it to the field
+   *    @param  exact
+   *            SHUNT_CAL from shuntCal()
+   *    @return The register value
+   */
+  static constexpr uint16_t shuntCalRegister(float exact) {
+    return exact < 0.5f ? 0
+           : exact + 0.5f >= shunt_cal_max
+               ? shunt_cal_max
+               : (uint16_t)(exact + 0.5f);
+  }
+
+  /*!
+   *    @brief  Checks that SHUNT_CAL rounds to a non-zero value that fits
+   *            the field, so shuntCalRegister() did not clamp it
+   *    @param  exact
+   *            SHUNT_CAL from shuntCal()
+   *    @return True if it does
+   */
+  static constexpr bool shuntCalFits(float exact) {
+    return exact >= 0.5f && exact + 0.5f < shunt_cal_max + 1;
+  }
+};
+
+class INA228_Calibration;
+
+/**
+ * @brief Complete chip setup, written by Adafruit_INA228::applyConfig.
+ *
+ * Every field starts at the chip's power-on value, except for the shunt
+ * which matches the setShunt defaults.
+ */
+struct INA228_Config {
+  INA2XX_MeasurementMode mode = INA2XX_MODE_CONTINUOUS; ///< Measurement mode
+  INA2XX_AveragingCount averaging = INA2XX_COUNT_1;     ///< Averaging count
+  INA2XX_ConversionTime bus_time = INA2XX_TIME_1052_us; ///< VBUSCT
+  INA2XX_ConversionTime shunt_time = INA2XX_TIME_1052_us; ///< VSHCT
+  INA2XX_ConversionTime temp_time = INA2XX_TIME_1052_us;  ///< VTCT
+  uint8_t adc_range = 0;           ///< Shunt ADC range, 0 or 1
+  uint8_t conversion_delay = 0;    ///< Delay before the first conversion, 2ms
+  bool temp_compensation = false;  ///< Enable shunt temperature compensation
+  uint16_t shunt_tempco = 0;       ///< Shunt tempco in ppm/deg C, 0 to 16383
+  float shunt_res = 0.1;           ///< Shunt resistance in ohms
+  float max_current = 3.2;         ///< Maximum expected current in A
+  const INA228_Calibration* calibration = NULL; ///< Used instead of the two
+                                                ///< fields above if set
+};
+
 /*!
  *    @brief  Class that stores state and functions for interacting with
  *            INA228 Current and Power Sensor
+ *
+ *    An instance takes about 145 bytes of RAM on AVR and 180 bytes on
+ *    32-bit ARM, all of it inside the object. INA2XX_ENABLE_STATS adds 60
+ *    bytes per INA2XX_Op.
  */
-class Adafruit_INA228 : public Adafruit_INA2xx {
+class Adafruit_INA228 : public Adafruit_INA2xx_Chip<INA228_Traits> {
  public:
   Adafruit_INA228();
-  bool begin(uint8_t i2c_addr = INA228_I2CADDR_DEFAULT,
+  using Adafruit_INA2xx_Chip<INA228_Traits>::begin;
+#if defined(ARDUINO)
+  bool begin(const INA228_Calibration& calibration,
+             uint8_t i2c_addr = INA228_I2CADDR_DEFAULT,
+             TwoWire* theWire = &Wire, bool skipReset = false);
+  bool begin(const INA228_Config& config,
+             uint8_t i2c_addr = INA228_I2CADDR_DEFAULT,
              TwoWire* theWire = &Wire, bool skipReset = false);
-  void reset(void) override;
+#endif
+  bool setCalibration(const INA228_Calibration& calibration);
+  bool applyConfig(const INA228_Config& config);
 
   // INA228 specific functions
   float readEnergy(void);
   float readCharge(void);
+  uint64_t readEnergyRaw(void);
+  int64_t readChargeRaw(void);
+  int64_t readEnergy_uJ(void);
+  int64_t readCharge_uC(void);
+  int64_t energyToMicrojoules(int64_t energy_raw);
+  int64_t chargeToMicrocoulombs(int64_t charge_raw);
   INA228_AlertType getAlertType(void);
-  void setAlertType(INA228_AlertType alert);
-  void resetAccumulators(void);
-  float readDieTemp(void) override;
-  float readBusVoltage(void) override;
-  void setShunt(float shunt_res = 0.1, float max_current = 3.2) override;
-
-  // INA228 specific register pointer
-  Adafruit_I2CRegister* AlertLimit; ///< BusIO Register for AlertLimit
+  bool setAlertType(INA228_AlertType alert);
+  bool resetAccumulators(void);
+  bool readSnapshot(INA228_Snapshot& snapshot,
+                    uint8_t channels = INA228_CHANNEL_ALL);
+  bool readSnapshotAsync(INA228_AsyncSnapshot& request, uint8_t channels,
+                         INA228_SnapshotCallback callback,
+                         void* context = NULL);
+  float achievableSampleRate(uint8_t channels = INA228_CHANNEL_ALL);
+  bool setShunt(float shunt_res = 0.1, float max_current = 3.2) final;
 
  protected:
-  void _updateShuntCalRegister(void) override;
+  void _setAccumulatorScales(void);
+  bool _applyConfig(const INA228_Config& config, bool from_reset);
+  static uint8_t _snapshotReads(INA2xx_RegisterRead* reads,
+                                uint8_t (*buffers)[INA228_SNAPSHOT_WIDTH],
+                                uint8_t channels);
+  void _decodeSnapshot(INA228_Snapshot& snapshot, uint8_t channels,
+                       const uint8_t (*buffers)[INA228_SNAPSHOT_WIDTH],
+                       uint8_t range);
+  static void _snapshotDone(INA2xx_Transfer* transfer);
+
+  INA2XX_FixedScale _energy_scale; ///< uJ per ENERGY LSB
+  INA2XX_FixedScale _charge_scale; ///< uC per CHARGE LSB
 };
 
 #endif
\ No newline at end of file
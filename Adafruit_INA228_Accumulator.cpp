@@ -0,0 +1,222 @@
+/*!
+ *  @file Adafruit_INA228_Accumulator.cpp
+ *
+ * 	64-bit host-side extension of the INA228 energy and charge accumulators
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_INA228_Accumulator.h"
+
+/*!
+ *    @brief  Instantiates a new tracker
+ *    @param  ina228
+ *            The sensor whose accumulators are followed
+ */
+INA228_AccumulatorTracker::INA228_AccumulatorTracker(Adafruit_INA228* ina228)
+    : _ina228(ina228) {
+  _last_energy = 0;
+  _last_charge = 0;
+  clear();
+}
+
+/**************************************************************************/
+/*!
+    @brief Takes the current register values as the starting point. The
+    chip accumulators are not reset.
+    @return True if the registers were read successfully
+*/
+/**************************************************************************/
+bool INA228_AccumulatorTracker::begin(void) {
+  INA228_Snapshot snapshot;
+  if (!_ina228->readSnapshot(snapshot, INA228_CHANNEL_ENERGY |
+                                           INA228_CHANNEL_CHARGE)) {
+    return false;
+  }
+  _last_energy = snapshot.energy_raw;
+  _last_charge = (uint64_t)snapshot.charge_raw & INA228_ACCUMULATOR_MASK;
+  clear();
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the accumulators and adds the change since the last call to
+    the 64-bit totals
+    @return True if the registers were read successfully
+*/
+/**************************************************************************/
+bool INA228_AccumulatorTracker::update(void) {
+  INA228_Snapshot snapshot;
+  if (!_ina228->readSnapshot(snapshot, INA228_CHANNEL_ENERGY |
+                                           INA228_CHANNEL_CHARGE)) {
+    return false;
+  }
+  return _fold(snapshot.energy_raw, snapshot.charge_raw);
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the totals and restarts both the chip accumulators and
+    the host totals from zero
+    @note The chip is reset right after the read, so at most the counts of
+    the conversion in progress between the two transactions are lost.
+    @param energy_raw
+          Set to the energy count since the last reset
+    @param charge_raw
+          Set to the charge count since the last reset
+    @return True if the registers were read and the chip was reset. If the
+    reset write fails the read is still added to the totals, which are
+    kept, so the next update() carries on from there.
+*/
+/**************************************************************************/
+bool INA228_AccumulatorTracker::readAndReset(uint64_t* energy_raw,
+                                             int64_t* charge_raw) {
+  INA228_Snapshot snapshot;
+  if (!_ina228->readSnapshot(snapshot, INA228_CHANNEL_ENERGY |
+                                           INA228_CHANNEL_CHARGE)) {
+    return false;
+  }
+  _fold(snapshot.energy_raw, snapshot.charge_raw);
+  if (!_ina228->resetAccumulators()) {
+    return false;
+  }
+
+  *energy_raw = _energy;
+  *charge_raw = _charge;
+  _last_energy = 0;
+  _last_charge = 0;
+  clear();
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Clears the host totals without touching the chip
+*/
+/**************************************************************************/
+void INA228_AccumulatorTracker::clear(void) {
+  _energy = 0;
+  _charge = 0;
+  _energy_wraps = 0;
+  _charge_wraps = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief Adds the change between two register readings to the totals
+    @param energy
+          New ENERGY register value
+    @param charge
+          New CHARGE register value, any sign extension is ignored
+    @return Always true
+*/
+/**************************************************************************/
+bool INA228_AccumulatorTracker::_fold(uint64_t energy, uint64_t charge) {
+  charge &= INA228_ACCUMULATOR_MASK;
+
+  // modulo 2^40 differences are correct across a single wrap
+  uint64_t energy_delta = (energy - _last_energy) & INA228_ACCUMULATOR_MASK;
+  if (energy < _last_energy) {
+    _energy_wraps++;
+  }
+
+  int64_t charge_delta =
+      _signExtend40((charge - _last_charge) & INA228_ACCUMULATOR_MASK);
+  // the register wrapped if it moved against the sign of the delta
+  int64_t old_charge = _signExtend40(_last_charge);
+  int64_t new_charge = _signExtend40(charge);
+  if ((charge_delta > 0 && new_charge < old_charge) ||
+      (charge_delta < 0 && new_charge > old_charge)) {
+    _charge_wraps++;
+  }
+
+  _energy += energy_delta;
+  _charge += charge_delta;
+  _last_energy = energy;
+  _last_charge = charge;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Sign extends a 40-bit two's complement value
+    @param value
+          The 40-bit pattern
+    @return The value as a signed 64-bit integer
+*/
+/**************************************************************************/
+int64_t INA228_AccumulatorTracker::_signExtend40(uint64_t value) {
+  if (value & ((uint64_t)1 << 39)) {
+    value |= 0xFFFFFF0000000000; // Sign extend to 64 bits
+  }
+  return (int64_t)value;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the extended energy total
+    @return Energy count since begin() or the last reset
+*/
+/**************************************************************************/
+uint64_t INA228_AccumulatorTracker::energyRaw(void) {
+  return _energy;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the extended charge total
+    @return Charge count since begin() or the last reset
+*/
+/**************************************************************************/
+int64_t INA228_AccumulatorTracker::chargeRaw(void) {
+  return _charge;
+}
+
+/**************************************************************************/
+/*!
+    @brief Converts the energy total with the sensor calibration
+    @return Energy since begin() or the last reset in uJ
+*/
+/**************************************************************************/
+int64_t INA228_AccumulatorTracker::energy_uJ(void) {
+  return _ina228->energyToMicrojoules(_energy);
+}
+
+/**************************************************************************/
+/*!
+    @brief Converts the charge total with the sensor calibration
+    @return Charge since begin() or the last reset in uC
+*/
+/**************************************************************************/
+int64_t INA228_AccumulatorTracker::charge_uC(void) {
+  return _ina228->chargeToMicrocoulombs(_charge);
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns how often the ENERGY register wrapped
+    @return Number of wraps seen since the last clear
+*/
+/**************************************************************************/
+uint32_t INA228_AccumulatorTracker::energyWraps(void) {
+  return _energy_wraps;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns how often the CHARGE register wrapped
+    @return Number of wraps seen since the last clear
+*/
+/**************************************************************************/
+uint32_t INA228_AccumulatorTracker::chargeWraps(void) {
+  return _charge_wraps;
+}
@@ -0,0 +1,60 @@
+/*!
+ *  @file Adafruit_INA228_Accumulator.h
+ *
+ * 	64-bit host-side extension of the INA228 energy and charge accumulators
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_ACCUMULATOR_H
+#define _ADAFRUIT_INA228_ACCUMULATOR_H
+
+#include "Adafruit_INA228.h"
+
+#define INA228_ACCUMULATOR_MASK 0xFFFFFFFFFFULL ///< 40-bit register mask
+
+/*!
+ *    @brief  Follows the 40-bit ENERGY and CHARGE registers and extends them
+ *            into 64-bit totals, so register wraparound is not lost.
+ *
+ *    update() has to be called at least once per wrap period of the
+ *    registers. CHARGE is the tighter limit, 2^39 current LSBs: about twelve
+ *    days at the full scale current.
+ */
+class INA228_AccumulatorTracker {
+ public:
+  INA228_AccumulatorTracker(Adafruit_INA228* ina228);
+  bool begin(void);
+  bool update(void);
+  bool readAndReset(uint64_t* energy_raw, int64_t* charge_raw);
+  void clear(void);
+
+  uint64_t energyRaw(void);
+  int64_t chargeRaw(void);
+  int64_t energy_uJ(void);
+  int64_t charge_uC(void);
+  uint32_t energyWraps(void);
+  uint32_t chargeWraps(void);
+
+ private:
+  bool _fold(uint64_t energy, uint64_t charge);
+  static int64_t _signExtend40(uint64_t value);
+
+  Adafruit_INA228* _ina228; ///< Sensor being tracked
+  uint64_t _last_energy; ///< Last ENERGY register value
+  uint64_t _last_charge; ///< Last CHARGE register value, 40-bit pattern
+  uint64_t _energy;      ///< Extended energy total
+  int64_t _charge;       ///< Extended charge total
+  uint32_t _energy_wraps; ///< ENERGY wraps since the last clear
+  uint32_t _charge_wraps; ///< CHARGE wraps since the last clear
+};
+
+#endif
@@ -0,0 +1,271 @@
+/*!
+ *  @file Adafruit_INA228_Acquisition.cpp
+ *
+ * 	ALERT pin driven sample acquisition for the INA228
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_INA228_Acquisition.h"
+
+INA228_Acquisition* INA228_Acquisition::_instances[INA228_ACQUISITION_MAX_PINS];
+
+/*!
+ *    @brief  Instantiates a new acquisition helper
+ *    @param  ina228
+ *            The sensor to sample, begin() must already have been called
+ *    @param  channels
+ *            INA228_Channel bits to read for every conversion
+ */
+INA228_Acquisition::INA228_Acquisition(Adafruit_INA228* ina228,
+                                       uint8_t channels)
+    : _ina228(ina228),
+      _channels(channels),
+      _alert_pin(-1),
+      _slot(-1),
+      _statistics(NULL),
+      _last_edge_us(0),
+      _period_us(0),
+      _have_edge(false),
+      _overruns(0),
+      _missed(0),
+      _dropped_edges(0) {}
+
+/**************************************************************************/
+/*!
+    @brief Routes conversion ready to the ALERT pin and attaches the pin
+    interrupt
+    @param alert_pin
+          The pin wired to ALERT, it must support interrupts. Pass -1 to
+          skip attaching and call handleAlert() from your own handler.
+    @return True if the sensor was set up and the interrupt attached
+*/
+/**************************************************************************/
+bool INA228_Acquisition::begin(int8_t alert_pin) {
+  end();
+
+  // latch so every conversion keeps ALERT asserted until it is read out
+  _ina228->setAlertLatch(INA2XX_ALERT_LATCH_ENABLED);
+  if (!_ina228->setAlertType(INA228_ALERT_CONVERSION_READY)) {
+    return false;
+  }
+  _ina228->conversionReady(); // clear a stale flag so the next edge is seen
+  _have_edge = false;
+
+  if (alert_pin < 0) {
+    return true;
+  }
+  for (uint8_t i = 0; i < INA228_ACQUISITION_MAX_PINS; i++) {
+    if (_instances[i] == NULL) {
+      _slot = i;
+      break;
+    }
+  }
+  if (_slot < 0) {
+    return false;
+  }
+  _instances[_slot] = this;
+  _alert_pin = alert_pin;
+
+  // ALERT is open drain, active low unless the polarity is inverted
+  bool inverted =
+      _ina228->getAlertPolarity() == INA2XX_ALERT_POLARITY_INVERTED;
+  pinMode(alert_pin, inverted ? INPUT : INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(alert_pin), _slot ? _isr1 : _isr0,
+                  inverted ? RISING : FALLING);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Detaches the pin interrupt. Buffered samples are kept.
+*/
+/**************************************************************************/
+void INA228_Acquisition::end(void) {
+  if (_alert_pin >= 0) {
+    detachInterrupt(digitalPinToInterrupt(_alert_pin));
+    _alert_pin = -1;
+  }
+  if (_slot >= 0) {
+    _instances[_slot] = NULL;
+    _slot = -1;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Records a conversion ready edge. Safe to call from an interrupt.
+*/
+/**************************************************************************/
+void INA228_Acquisition::handleAlert(void) {
+  if (!_edges.push(micros())) {
+    _dropped_edges++;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Feeds every sample service() reads into running statistics,
+    including the ones dropped because the buffer was full
+    @param statistics
+          The statistics to update, NULL to stop
+*/
+/**************************************************************************/
+void INA228_Acquisition::setStatistics(INA228_Statistics* statistics) {
+  _statistics = statistics;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads out the sensor if a conversion completed since the last
+    call. Only the newest conversion can be read. With the latch enabled
+    ALERT gives no edge for conversions that finish before service() reads
+    DIAG_ALRT, so those are counted from the time between edges and the
+    conversion period.
+    @return Number of samples added to the buffer, 0 or 1
+*/
+/**************************************************************************/
+uint8_t INA228_Acquisition::service(void) {
+  uint32_t timestamp;
+  if (!_edges.pop(timestamp)) {
+    return 0;
+  }
+  uint32_t superseded = 0;
+  uint32_t newer;
+  while (_edges.pop(newer)) {
+    timestamp = newer;
+    superseded++;
+  }
+
+  _period_us = _ina228->conversionPeriodMicros();
+  if (!_period_us || !_have_edge) {
+    // triggered, shut down or the first edge, nothing to measure against
+    _missed += superseded;
+  } else {
+    // round to the nearest period, edges jitter by the interrupt latency
+    uint32_t periods =
+        (timestamp - _last_edge_us + _period_us / 2) / _period_us;
+    if (periods > 1) {
+      _missed += periods - 1;
+    }
+  }
+  _last_edge_us = timestamp;
+  _have_edge = true;
+
+  INA228_Snapshot snapshot;
+  bool ok = _ina228->readSnapshot(snapshot, _channels);
+  // reading DIAG_ALRT releases the latched ALERT pin for the next edge
+  _ina228->conversionReady();
+  if (!ok) {
+    return 0;
+  }
+  snapshot.timestamp_us = timestamp;
+  if (_statistics) {
+    _statistics->add(snapshot);
+  }
+  if (!_samples.push(snapshot)) {
+    _overruns++;
+    return 0;
+  }
+  return 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the number of buffered samples
+    @return Samples ready to be read
+*/
+/**************************************************************************/
+uint8_t INA228_Acquisition::available(void) {
+  return _samples.available();
+}
+
+/**************************************************************************/
+/*!
+    @brief Takes the oldest sample from the buffer
+    @param snapshot
+          Set to the sample
+    @return False if the buffer was empty
+*/
+/**************************************************************************/
+bool INA228_Acquisition::read(INA228_Snapshot& snapshot) {
+  return _samples.pop(snapshot);
+}
+
+/**************************************************************************/
+/*!
+    @brief Takes a batch of samples from the buffer, oldest first
+    @param snapshots
+          Array to receive the samples
+    @param max
+          Size of the array
+    @return Number of samples copied
+*/
+/**************************************************************************/
+uint8_t INA228_Acquisition::read(INA228_Snapshot* snapshots, uint8_t max) {
+  return _samples.pop(snapshots, max);
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the number of samples dropped because the buffer was full
+    @return Dropped sample count
+*/
+/**************************************************************************/
+uint32_t INA228_Acquisition::overruns(void) {
+  return _overruns;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the number of conversions that completed but were
+    overwritten before service() read them out, measured from the
+    conversion period while the sensor runs continuously
+    @return Missed conversion count
+*/
+/**************************************************************************/
+uint32_t INA228_Acquisition::missedConversions(void) {
+  // edges dropped by a full buffer are already in the measured gaps
+  return _missed + (_period_us ? 0 : _dropped_edges);
+}
+
+/**************************************************************************/
+/*!
+    @brief Clears the overrun and missed conversion counters
+*/
+/**************************************************************************/
+void INA228_Acquisition::clearCounters(void) {
+  _overruns = 0;
+  _missed = 0;
+  _dropped_edges = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief Interrupt trampoline for the first attached instance
+*/
+/**************************************************************************/
+void INA228_Acquisition::_isr0(void) {
+  if (_instances[0]) {
+    _instances[0]->handleAlert();
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Interrupt trampoline for the second attached instance
+*/
+/**************************************************************************/
+void INA228_Acquisition::_isr1(void) {
+  if (_instances[1]) {
+    _instances[1]->handleAlert();
+  }
+}
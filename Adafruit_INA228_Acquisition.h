@@ -0,0 +1,82 @@
+/*!
+ *  @file Adafruit_INA228_Acquisition.h
+ *
+ * 	ALERT pin driven sample acquisition for the INA228
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_ACQUISITION_H
+#define _ADAFRUIT_INA228_ACQUISITION_H
+
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Statistics.h"
+#include "Adafruit_INA2xx_RingBuffer.h"
+
+#ifndef INA228_ACQUISITION_DEPTH
+#if defined(__AVR__)
+#define INA228_ACQUISITION_DEPTH 4 ///< Samples buffered per instance
+#else
+#define INA228_ACQUISITION_DEPTH 16 ///< Samples buffered per instance
+#endif
+#endif
+
+#define INA228_ACQUISITION_MAX_PINS 2 ///< Instances that can attach a pin
+
+/*!
+ *    @brief  Collects one snapshot per completed conversion, signalled by the
+ *            ALERT pin, into a ring buffer that the main loop drains.
+ *
+ *    The interrupt only records a timestamp. The I2C reads happen in
+ *    service(), which has to be called from the loop (or a single task), so
+ *    no bus traffic is spent polling for conversion ready.
+ */
+class INA228_Acquisition {
+ public:
+  INA228_Acquisition(Adafruit_INA228* ina228,
+                     uint8_t channels = INA228_CHANNEL_ALL);
+  bool begin(int8_t alert_pin);
+  void end(void);
+  void handleAlert(void);
+  void setStatistics(INA228_Statistics* statistics);
+
+  uint8_t service(void);
+  uint8_t available(void);
+  bool read(INA228_Snapshot& snapshot);
+  uint8_t read(INA228_Snapshot* snapshots, uint8_t max);
+
+  uint32_t overruns(void);
+  uint32_t missedConversions(void);
+  void clearCounters(void);
+
+ private:
+  static void _isr0(void);
+  static void _isr1(void);
+  static INA228_Acquisition* _instances[INA228_ACQUISITION_MAX_PINS];
+
+  Adafruit_INA228* _ina228;       ///< Sensor being sampled
+  uint8_t _channels;              ///< INA228_Channel bits read per sample
+  int8_t _alert_pin;              ///< Attached pin, -1 if none
+  int8_t _slot;                   ///< Index in _instances, -1 if none
+  INA228_Statistics* _statistics; ///< Fed every sample, NULL for none
+  INA2xx_RingBuffer<uint32_t, INA228_ACQUISITION_DEPTH>
+      _edges; ///< ALERT edge timestamps, filled by the interrupt
+  INA2xx_RingBuffer<INA228_Snapshot, INA228_ACQUISITION_DEPTH>
+      _samples;                     ///< Completed samples, drained by the loop
+  uint32_t _last_edge_us;           ///< Edge of the last serviced sample
+  uint32_t _period_us;              ///< Conversion period, 0 if unknown
+  bool _have_edge;                  ///< _last_edge_us is valid
+  uint32_t _overruns;               ///< Samples dropped, buffer full
+  uint32_t _missed;                 ///< Conversions never read out
+  volatile uint32_t _dropped_edges; ///< Edges dropped by the interrupt
+};
+
+#endif
@@ -0,0 +1,255 @@
+/*!
+ *  @file Adafruit_INA228_Array.h
+ *
+ * 	Bus manager for several INA228 sensors sharing one I2C bus
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_ARRAY_H
+#define _ADAFRUIT_INA228_ARRAY_H
+
+#include "Adafruit_INA228.h"
+
+#define INA228_ARRAY_FIRST_ADDR 0x40 ///< Lowest INA228 address
+#define INA228_ARRAY_ADDRESSES 16    ///< Number of INA228 addresses
+
+/*!
+ *    @brief  Owns up to MAX_DEVICES INA228s on one TwoWire bus, all
+ *            storage fixed size. Snapshots are kept in one contiguous array
+ *            indexed by the order the devices were added.
+ *
+ *    service() reads one device per call, always the most overdue one, so
+ *    devices with a shorter interval get read more often and equal
+ *    intervals go round-robin. Devices whose registers can't hold a new
+ *    conversion yet (see Adafruit_INA2xx::newConversionSince) are skipped.
+ */
+template <uint8_t MAX_DEVICES = INA228_ARRAY_ADDRESSES>
+class INA228Array {
+ public:
+  /*!
+   *    @brief  Instantiates an empty array
+   *    @param  theWire
+   *            The Wire object shared by all devices
+   *    @param  channels
+   *            INA228_Channel bits read from every device
+   */
+  INA228Array(TwoWire* theWire = &Wire, uint8_t channels = INA228_CHANNEL_ALL)
+      : _wire(theWire), _channels(channels), _count(0) {
+    for (uint8_t i = 0; i < INA228_ARRAY_ADDRESSES; i++) {
+      _slots[i] = -1;
+    }
+  }
+
+  /*!
+   *    @brief  Sets up a device and adds it to the array
+   *    @param  i2c_addr
+   *            The device address, 0x40 to 0x4F
+   *    @param  shunt_res
+   *            Resistance of the shunt in ohms
+   *    @param  max_current
+   *            Maximum expected current in A
+   *    @param  interval_us
+   *            Minimum time between reads of this device, 0 to read it as
+   *            often as new conversions are available
+   *    @param  skipReset
+   *            Passed on to Adafruit_INA228::begin
+   *    @return Index of the device, or -1 if it was not found, the array
+   *            is full, the register cache couldn't be loaded or SHUNT_CAL
+   *            couldn't be written or doesn't fit for this shunt and current
+   */
+  int8_t add(uint8_t i2c_addr, float shunt_res = 0.1, float max_current = 3.2,
+             uint32_t interval_us = 0, bool skipReset = false) {
+    uint8_t offset = i2c_addr - INA228_ARRAY_FIRST_ADDR;
+    if (offset >= INA228_ARRAY_ADDRESSES || _slots[offset] >= 0 ||
+        _count >= MAX_DEVICES) {
+      return -1;
+    }
+    Adafruit_INA228& device = _devices[_count];
+    // don't wait for the first conversion, service() skips the device
+    // until it is ready so several sensors start up side by side
+    if (!device.beginAsync(i2c_addr, _wire, skipReset)) {
+      return -1;
+    }
+    // the array is the only writer, so serve configuration from memory
+    if (!device.enableRegisterCache() ||
+        !device.setShunt(shunt_res, max_current)) {
+      // leave the slot as a later add() expects to find it
+      device.enableRegisterCache(false);
+      return -1;
+    }
+
+    _addresses[_count] = i2c_addr;
+    _interval[_count] = interval_us;
+    _last_read[_count] = micros() - interval_us;
+    _read_once[_count] = false;
+    _failures[_count] = 0;
+    _snapshots[_count].mask = 0;
+    _snapshots[_count].timestamp_us = micros();
+    _slots[offset] = _count;
+    return _count++;
+  }
+
+  /*!
+   *    @brief  Reads every device once, in index order
+   *    @param  force
+   *            Read devices even if they have no new conversion
+   *    @return Number of devices read successfully
+   */
+  uint8_t readAll(bool force = false) {
+    uint8_t read = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+      if (force || _hasNewData(i)) {
+        read += _read(i);
+      }
+    }
+    return read;
+  }
+
+  /*!
+   *    @brief  Reads the most overdue device that has new data
+   *    @return Index of the device read, or -1 if none was due
+   */
+  int8_t service(void) {
+    uint32_t now = micros();
+    int8_t best = -1;
+    int32_t best_overdue = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+      int32_t overdue = (int32_t)(now - _last_read[i] - _interval[i]);
+      if (overdue < 0 || !_hasNewData(i)) {
+        continue;
+      }
+      if (best < 0 || overdue > best_overdue) {
+        best = i;
+        best_overdue = overdue;
+      }
+    }
+    if (best >= 0) {
+      _read(best);
+    }
+    return best;
+  }
+
+  /*!
+   *    @brief  Returns the number of devices added
+   *    @return Device count
+   */
+  uint8_t count(void) const {
+    return _count;
+  }
+
+  /*!
+   *    @brief  Looks up a device index by address
+   *    @param  i2c_addr
+   *            The device address
+   *    @return Index of the device, or -1 if there is none at the address
+   */
+  int8_t indexOf(uint8_t i2c_addr) const {
+    uint8_t offset = i2c_addr - INA228_ARRAY_FIRST_ADDR;
+    return offset < INA228_ARRAY_ADDRESSES ? _slots[offset] : -1;
+  }
+
+  /*!
+   *    @brief  Returns a device for direct configuration
+   *    @param  index
+   *            Device index
+   *    @return The device
+   */
+  Adafruit_INA228& device(uint8_t index) {
+    return _devices[index];
+  }
+
+  /*!
+   *    @brief  Returns the address of a device
+   *    @param  index
+   *            Device index
+   *    @return The I2C address
+   */
+  uint8_t address(uint8_t index) const {
+    return _addresses[index];
+  }
+
+  /*!
+   *    @brief  Returns the latest snapshots of all devices, one per index
+   *    @return Pointer to count() contiguous snapshots
+   */
+  const INA228_Snapshot* snapshots(void) const {
+    return _snapshots;
+  }
+
+  /*!
+   *    @brief  Returns how old the latest snapshot of a device is
+   *    @param  index
+   *            Device index
+   *    @return Time since the last successful read in us, 0xFFFFFFFF if
+   *            the device has not been read yet
+   */
+  uint32_t staleness(uint8_t index) const {
+    if (!_read_once[index]) {
+      return 0xFFFFFFFF;
+    }
+    return micros() - _snapshots[index].timestamp_us;
+  }
+
+  /*!
+   *    @brief  Returns how many reads of a device failed
+   *    @param  index
+   *            Device index
+   *    @return Failed read count
+   */
+  uint32_t failures(uint8_t index) const {
+    return _failures[index];
+  }
+
+ private:
+  /*!
+   *    @brief  Checks whether a device may hold an unread conversion
+   *    @param  i
+   *            Device index
+   *    @return True if the device should be read
+   */
+  bool _hasNewData(uint8_t i) {
+    if (!_read_once[i]) {
+      return _devices[i].startupState() != INA2XX_CONVERSION_PENDING;
+    }
+    return _devices[i].newConversionSince(_last_read[i]);
+  }
+
+  /*!
+   *    @brief  Reads the snapshot of a device
+   *    @param  i
+   *            Device index
+   *    @return 1 if the read succeeded, 0 otherwise
+   */
+  uint8_t _read(uint8_t i) {
+    _last_read[i] = micros();
+    if (!_devices[i].readSnapshot(_snapshots[i], _channels)) {
+      _failures[i]++;
+      return 0;
+    }
+    _read_once[i] = true;
+    return 1;
+  }
+
+  TwoWire* _wire;    ///< Bus shared by all devices
+  uint8_t _channels; ///< INA228_Channel bits read per device
+  uint8_t _count;    ///< Devices added
+  int8_t _slots[INA228_ARRAY_ADDRESSES]; ///< Index by address, -1 if unused
+  Adafruit_INA228 _devices[MAX_DEVICES]; ///< The sensors
+  INA228_Snapshot _snapshots[MAX_DEVICES]; ///< Latest reading per device
+  uint32_t _interval[MAX_DEVICES];         ///< Minimum read interval in us
+  uint32_t _last_read[MAX_DEVICES];        ///< micros() of the last read
+  uint32_t _failures[MAX_DEVICES];         ///< Failed reads per device
+  uint8_t _addresses[MAX_DEVICES];         ///< Address per device
+  bool _read_once[MAX_DEVICES]; ///< True after the first successful read
+};
+
+#endif
@@ -0,0 +1,171 @@
+/*!
+ *  @file Adafruit_INA228_Calibration.h
+ *
+ * 	Compile-time shunt calibration for the INA228
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_CALIBRATION_H
+#define _ADAFRUIT_INA228_CALIBRATION_H
+
+#include "Adafruit_INA228.h"
+
+/// SHUNT_CAL is a 15-bit field
+#define INA228_SHUNTCAL_MAX INA228_Traits::shunt_cal_max
+#define INA228_SHUNTCAL_MIN 50     ///< Below this rounding costs over 1%
+
+/*!
+ *    @brief  Shunt calibration worked out by the compiler: the SHUNT_CAL
+ *            word and the fixed-point scales of every result register
+ *
+ *    Declare it constexpr and check it with static_assert, or use
+ *    INA228_CALIBRATION which does both. Applying it with
+ *    Adafruit_INA228::setCalibration() or begin() only copies integers
+ *    and writes SHUNT_CAL, so no floating point math runs on the target.
+ */
+class INA228_Calibration {
+ public:
+  /*!
+   *    @brief  Works out the calibration
+   *    @param  shunt_ohms
+   *            Resistance of the shunt in ohms
+   *    @param  max_current_A
+   *            Maximum expected current in A
+   *    @param  range
+   *            Shunt ADC range, 0 (+/-163.84 mV) or 1 (+/-40.96 mV)
+   */
+  constexpr INA228_Calibration(double shunt_ohms, double max_current_A,
+                               uint8_t range = 0)
+      : shunt_res(shunt_ohms), current_lsb(_lsb(max_current_A)),
+        adc_range(range ? 1 : 0),
+        shunt_cal_exact(INA228_Traits::shuntCal(
+            (float)shunt_ohms, _lsbFloat(max_current_A), range)),
+        shunt_cal(INA228_Traits::shuntCalRegister(INA228_Traits::shuntCal(
+            (float)shunt_ohms, _lsbFloat(max_current_A), range))),
+        current_scale(_scale(_lsbFloat(max_current_A) * 1e6)),
+        power_scale(_scale(INA228_Traits::powerLsbFactor() *
+                           _lsbFloat(max_current_A) * 1e6)),
+        energy_scale(_scale(16 * INA228_Traits::powerLsbFactor() *
+                            _lsbFloat(max_current_A) * 1e6)),
+        charge_scale(_scale(_lsbFloat(max_current_A) * 1e6)) {}
+
+  /*!
+   *    @brief  Checks that the SHUNT_CAL value fits its 15-bit field
+   *    @return True if it does
+   */
+  constexpr bool fits(void) const {
+    return INA228_Traits::shuntCalFits(shunt_cal_exact);
+  }
+
+  /*!
+   *    @brief  Checks that rounding SHUNT_CAL to an integer costs less than
+   *            1% of accuracy
+   *    @return True if it does
+   */
+  constexpr bool precise(void) const {
+    return shunt_cal_exact >= INA228_SHUNTCAL_MIN;
+  }
+
+  /*!
+   *    @brief  Checks that the shunt voltage at the maximum current stays
+   *            inside the selected ADC range
+   *    @return True if it does
+   */
+  constexpr bool inRange(void) const {
+    // the maximum current is 2^19 current LSBs
+    return (double)shunt_res * current_lsb * (1UL << 19) <=
+           _fullScale(adc_range);
+  }
+
+  /*!
+   *    @brief  Runs all checks
+   *    @return True if the calibration can be used
+   */
+  constexpr bool valid(void) const {
+    return fits() && precise() && inRange();
+  }
+
+  float shunt_res;                 ///< Shunt resistance in ohms
+  float current_lsb;               ///< Current LSB in A
+  uint8_t adc_range;               ///< Shunt ADC range, 0 or 1
+  float shunt_cal_exact;           ///< SHUNT_CAL before rounding
+  uint16_t shunt_cal;              ///< SHUNT_CAL register value
+  INA2XX_FixedScale current_scale; ///< uA per CURRENT LSB
+  INA2XX_FixedScale power_scale;   ///< uW per POWER LSB
+  INA2XX_FixedScale energy_scale;  ///< uJ per ENERGY LSB
+  INA2XX_FixedScale charge_scale;  ///< uC per CHARGE LSB
+
+ private:
+  static constexpr double _lsb(double max_current_A) {
+    return max_current_A / (double)(1UL << INA228_Traits::current_lsb_bits);
+  }
+
+  // the driver keeps the current LSB as a float and its scales and
+  // SHUNT_CAL are worked out from that, with the same expressions as
+  // _setShuntScales() and _shuntCalFor()
+  static constexpr float _lsbFloat(double max_current_A) {
+    return (float)_lsb(max_current_A);
+  }
+
+  static constexpr double _fullScale(uint8_t range) {
+    // the shunt result is 20-bit two's complement
+    return (double)(1UL << 19) * INA228_Traits::shunt_lsb_nV /
+           (double)(1UL << (range ? INA228_Traits::shunt_lsb_shift_range1
+                                  : INA228_Traits::shunt_lsb_shift)) /
+           1e9;
+  }
+
+  // Adafruit_INA2xx::_makeScale as constant expressions, in double like
+  // it, so the same LSB expression gives the same multiplier.
+  static constexpr uint8_t _shift(double scaled, uint8_t shift) {
+    return (shift > 0 && scaled >= 4294967040.0)
+               ? _shift(scaled / 2, shift - 1)
+               : shift;
+  }
+
+  static constexpr INA2XX_FixedScale _scaleAt(double units_per_lsb,
+                                              uint8_t shift) {
+    return INA2XX_FixedScale{
+        (uint32_t)((units_per_lsb * (double)(1ULL << shift) >= 4294967040.0
+                        ? 4294967040.0
+                        : units_per_lsb * (double)(1ULL << shift)) +
+                   0.5),
+        shift};
+  }
+
+  static constexpr INA2XX_FixedScale _scale(double units_per_lsb) {
+    return _scaleAt(units_per_lsb, _shift(units_per_lsb * 4294967296.0, 32));
+  }
+};
+
+/*!
+ *    @brief  Declares a constexpr INA228_Calibration and rejects a bad one
+ *            at compile time
+ *    @param  name
+ *            Name of the calibration object
+ *    @param  shunt_ohms
+ *            Resistance of the shunt in ohms
+ *    @param  max_current_A
+ *            Maximum expected current in A
+ *    @param  range
+ *            Shunt ADC range, 0 or 1
+ */
+#define INA228_CALIBRATION(name, shunt_ohms, max_current_A, range)          \
+  constexpr INA228_Calibration name(shunt_ohms, max_current_A, range);      \
+  static_assert(name.fits(), "INA228: SHUNT_CAL does not fit in 15 bits, "  \
+                             "lower the shunt or the max current");         \
+  static_assert(name.precise(), "INA228: SHUNT_CAL too small to round "     \
+                                "accurately, raise the shunt or current");  \
+  static_assert(name.inRange(), "INA228: max current overflows the shunt "  \
+                                "ADC range, use range 0 or a smaller shunt")
+
+#endif
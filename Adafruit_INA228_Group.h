@@ -0,0 +1,233 @@
+/*!
+ *  @file Adafruit_INA228_Group.h
+ *
+ * 	Triggers several INA228 sensors together for time-aligned readings
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_GROUP_H
+#define _ADAFRUIT_INA228_GROUP_H
+
+#include "Adafruit_INA228.h"
+
+/*!
+ *    @brief  Starts a triggered conversion on up to MAX_DEVICES INA228s at
+ *            once and collects their snapshots, so readings taken on both
+ *            sides of a converter describe the same moment.
+ *
+ *    trigger() writes ADC_CONFIG of every device back to back. The value
+ *    comes from the register cache, so each trigger is a single write with
+ *    nothing in between. The time after each write is recorded, and skew()
+ *    reports how much later a device started converting than the first
+ *    one. poll() stays off the bus until the modelled conversion time of a
+ *    device has passed, then reads its snapshot.
+ *
+ *    The group does not own the devices, which must have been started with
+ *    begin() or beginAsync() and stay alive while they are in the group.
+ */
+template <uint8_t MAX_DEVICES>
+class INA228Group {
+ public:
+  /*!
+   *    @brief  Instantiates an empty group
+   *    @param  channels
+   *            INA228_Channel bits read from every device
+   */
+  INA228Group(uint8_t channels = INA228_CHANNEL_ALL)
+      : _channels(channels), _count(0) {}
+
+  /*!
+   *    @brief  Adds a device to the group and turns on its register cache,
+   *            so trigger() doesn't have to read ADC_CONFIG first
+   *    @param  device
+   *            A started device, not in the group yet
+   *    @return Index of the device, or -1 if the group is full
+   */
+  int8_t add(Adafruit_INA228& device) {
+    if (_count >= MAX_DEVICES) {
+      return -1;
+    }
+    device.enableRegisterCache();
+    _devices[_count] = &device;
+    _state[_count] = INA2XX_CONVERSION_IDLE;
+    _triggered[_count] = 0;
+    _snapshots[_count].mask = 0;
+    return _count++;
+  }
+
+  /*!
+   *    @brief  Starts a conversion on every device, in index order
+   *    @param  mode
+   *            A triggered mode, the same for all devices
+   *    @return True if every device took the trigger
+   */
+  bool trigger(INA2XX_MeasurementMode mode = INA2XX_MODE_TRIGGERED) {
+    bool ok = true;
+    // keep the loop down to the writes, the bookkeeping comes after
+    for (uint8_t i = 0; i < _count; i++) {
+      _state[i] = _devices[i]->startConversion(mode)
+                      ? INA2XX_CONVERSION_PENDING
+                      : INA2XX_CONVERSION_TIMEOUT;
+      _triggered[i] = micros();
+    }
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_state[i] != INA2XX_CONVERSION_PENDING) {
+        ok = false;
+        continue;
+      }
+      _due[i] = _devices[i]->conversionReadyAt() - _triggered[i];
+      _time[i] = _due[i];
+    }
+    return ok;
+  }
+
+  /*!
+   *    @brief  Reads the devices whose conversion is done. Never blocks,
+   *            and does no bus I/O for a device until its modelled
+   *            conversion time has passed.
+   *    @return INA2XX_CONVERSION_PENDING while any device is still
+   *            converting, INA2XX_CONVERSION_READY once all snapshots were
+   *            read, or INA2XX_CONVERSION_TIMEOUT if a device could not be
+   *            triggered or read
+   */
+  INA2XX_ConversionState poll(void) {
+    bool pending = false, failed = false;
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_state[i] == INA2XX_CONVERSION_PENDING) {
+        _poll(i);
+      }
+      pending |= _state[i] == INA2XX_CONVERSION_PENDING;
+      failed |= _state[i] != INA2XX_CONVERSION_READY;
+    }
+    if (pending) {
+      return INA2XX_CONVERSION_PENDING;
+    }
+    return failed ? INA2XX_CONVERSION_TIMEOUT : INA2XX_CONVERSION_READY;
+  }
+
+  /*!
+   *    @brief  Triggers all devices and blocks until their snapshots are in
+   *    @param  mode
+   *            A triggered mode, the same for all devices
+   *    @return True if every snapshot was read
+   */
+  bool sample(INA2XX_MeasurementMode mode = INA2XX_MODE_TRIGGERED) {
+    trigger(mode);
+    INA2XX_ConversionState state;
+    while ((state = poll()) == INA2XX_CONVERSION_PENDING) {
+      delayMicroseconds(50);
+    }
+    return state == INA2XX_CONVERSION_READY;
+  }
+
+  /*!
+   *    @brief  Returns the number of devices added
+   *    @return Device count
+   */
+  uint8_t count(void) const {
+    return _count;
+  }
+
+  /*!
+   *    @brief  Returns a device of the group
+   *    @param  index
+   *            Device index
+   *    @return The device
+   */
+  Adafruit_INA228& device(uint8_t index) {
+    return *_devices[index];
+  }
+
+  /*!
+   *    @brief  Returns where the last trigger() stands for one device
+   *    @param  index
+   *            Device index
+   *    @return The conversion state of the device
+   */
+  INA2XX_ConversionState state(uint8_t index) const {
+    return _state[index];
+  }
+
+  /*!
+   *    @brief  Returns the snapshots of the last trigger(), one per index
+   *    @return Pointer to count() contiguous snapshots
+   */
+  const INA228_Snapshot* snapshots(void) const {
+    return _snapshots;
+  }
+
+  /*!
+   *    @brief  Returns when a device was triggered
+   *    @param  index
+   *            Device index
+   *    @return micros() right after its ADC_CONFIG write finished
+   */
+  uint32_t triggerTime(uint8_t index) const {
+    return _triggered[index];
+  }
+
+  /*!
+   *    @brief  Returns how much later a device was triggered than the
+   *            first one. Limited by the resolution of micros(), 4 us on
+   *            16 MHz AVR.
+   *    @param  index
+   *            Device index
+   *    @return Skew in us, 0 for the first device
+   */
+  uint32_t skew(uint8_t index) const {
+    return _triggered[index] - _triggered[0];
+  }
+
+  /*!
+   *    @brief  Returns the skew between the first and the last device
+   *    @return Largest skew() of the last trigger() in us
+   */
+  uint32_t maxSkew(void) const {
+    return _count ? skew(_count - 1) : 0;
+  }
+
+ private:
+  /*!
+   *    @brief  Reads the snapshot of a pending device if it is done
+   *    @param  i
+   *            Device index
+   */
+  void _poll(uint8_t i) {
+    uint32_t elapsed = micros() - _triggered[i];
+    if (elapsed < _due[i]) {
+      return;
+    }
+    if (!_devices[i]->conversionReady()) {
+      // same back-off and timeout as Adafruit_INA2xx::poll
+      if (elapsed > 2 * _time[i] + 10000) {
+        _state[i] = INA2XX_CONVERSION_TIMEOUT;
+      } else {
+        _due[i] = elapsed + _time[i] / 16 + 50;
+      }
+      return;
+    }
+    _state[i] = _devices[i]->readSnapshot(_snapshots[i], _channels)
+                    ? INA2XX_CONVERSION_READY
+                    : INA2XX_CONVERSION_TIMEOUT;
+  }
+
+  uint8_t _channels; ///< INA228_Channel bits read per device
+  uint8_t _count;    ///< Devices added
+  Adafruit_INA228* _devices[MAX_DEVICES];  ///< The sensors, not owned
+  INA228_Snapshot _snapshots[MAX_DEVICES]; ///< Reading of the last trigger
+  INA2XX_ConversionState _state[MAX_DEVICES]; ///< Progress per device
+  uint32_t _triggered[MAX_DEVICES]; ///< micros() after each trigger write
+  uint32_t _due[MAX_DEVICES];       ///< Offset of the next ready check in us
+  uint32_t _time[MAX_DEVICES];      ///< Modelled conversion time in us
+};
+
+#endif
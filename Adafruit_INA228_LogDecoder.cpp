@@ -0,0 +1,346 @@
+/*!
+ *  @file Adafruit_INA228_LogDecoder.cpp
+ *
+ * 	Decoder for the packed binary INA228 log format. Plain C++, so logs
+ * 	can be read back on a Linux host as well as on the board.
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_INA228_LogDecoder.h"
+#include "Adafruit_INA228.h"
+
+/*!
+ *    @brief  Turns an LSB given as numerator >> shift into a double
+ *    @param  numerator
+ *            The LSB numerator from INA228_Traits
+ *    @param  shift
+ *            The matching shift
+ *    @param  unit
+ *            Numerator units per result unit
+ *    @return The LSB in result units
+ */
+static double traitsLsb(uint16_t numerator, uint8_t shift, double unit) {
+  return (double)numerator / (1UL << shift) / unit;
+}
+
+/*!
+ *    @brief  Instantiates a decoder waiting for a header
+ */
+INA228_LogDecoder::INA228_LogDecoder() {
+  reset();
+}
+
+/**************************************************************************/
+/*!
+    @brief Decodes the frame at the start of data
+    @param data
+          Log bytes, starting at a frame boundary or anywhere when the
+          decoder is not synced yet
+    @param len
+          Number of bytes available
+    @param used
+          Set to the number of bytes to advance by, 0 if more are needed
+    @param record
+          Filled in when INA228_LOG_RECORD is returned
+    @return What was found
+*/
+/**************************************************************************/
+INA228_LogStatus INA228_LogDecoder::decode(const uint8_t* data, size_t len,
+                                           size_t& used,
+                                           INA228_LogRecord& record) {
+  used = 0;
+  if (!len) {
+    return INA228_LOG_MORE;
+  }
+  uint8_t tag = data[0];
+  if (tag == INA228_LOG_HEADER) {
+    return _header(data, len, used);
+  }
+  bool keyframe = tag == INA228_LOG_KEYFRAME;
+  bool delta = tag <= INA228_LOG_DELTA_LONG;
+  if (!_configured || (!keyframe && (!delta || !_synced))) {
+    // no channel list yet, or not the start of a frame. Unsynced, a delta
+    // tag may be any byte, so step one byte at a time to the next keyframe.
+    return _skip(1, used);
+  }
+
+  int64_t values[INA228_LOG_CHANNELS + 1];
+  int16_t frame = _frame(data, len, values, keyframe);
+  if (frame == 0) {
+    return INA228_LOG_MORE;
+  }
+  if (frame < 0) {
+    return _skip(1, used);
+  }
+
+  // values[0] is the timestamp, or its delta-of-delta
+  uint32_t timestamp_us;
+  if (keyframe) {
+    timestamp_us = (uint32_t)values[0];
+    _last_delta_us = 0;
+    _slope[0] = _slope[1] = 0;
+  } else {
+    _last_delta_us += (int32_t)values[0];
+    timestamp_us = _last_us + _last_delta_us;
+  }
+  for (uint8_t i = 0; i < INA228_LOG_CHANNELS; i++) {
+    if (!(_channels & (1 << i))) {
+      continue;
+    }
+    int64_t value = values[i + 1];
+    if (!keyframe) {
+      if ((1 << i) & INA228_LOG_ACCUMULATORS) {
+        _slope[i - 5] += value;
+        value = _slope[i - 5];
+      }
+      value += _previous[i];
+    }
+    _previous[i] = value;
+  }
+  _last_us = timestamp_us;
+  _synced = true;
+  _records++;
+  _fill(record, timestamp_us, keyframe);
+  used = frame;
+  return INA228_LOG_RECORD;
+}
+
+/**************************************************************************/
+/*!
+    @brief Forgets the header and the last values, so the next log can
+    start
+*/
+/**************************************************************************/
+void INA228_LogDecoder::reset(void) {
+  for (uint8_t i = 0; i < INA228_LOG_CHANNELS; i++) {
+    _previous[i] = 0;
+  }
+  _slope[0] = _slope[1] = 0;
+  _last_delta_us = 0;
+  _last_us = 0;
+  _records = 0;
+  _skipped = 0;
+  _current_lsb = 0;
+  _shunt_res = 0;
+  _channels = 0;
+  _range = 0;
+  _configured = false;
+  _synced = false;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the channels of the log
+    @return INA228_Channel bits from the last header
+*/
+/**************************************************************************/
+uint8_t INA228_LogDecoder::channels(void) const {
+  return _channels;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the shunt ADC range of the log
+    @return 0 for +/-163.84 mV, 1 for +/-40.96 mV
+*/
+/**************************************************************************/
+uint8_t INA228_LogDecoder::adcRange(void) const {
+  return _range;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the current LSB of the log
+    @return Current per CURRENT LSB in A
+*/
+/**************************************************************************/
+float INA228_LogDecoder::currentLSB(void) const {
+  return _current_lsb;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the shunt resistance of the log
+    @return Shunt resistance in ohms
+*/
+/**************************************************************************/
+float INA228_LogDecoder::shuntResistance(void) const {
+  return _shunt_res;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the number of frames decoded
+    @return Records since construction or reset()
+*/
+/**************************************************************************/
+uint32_t INA228_LogDecoder::records(void) const {
+  return _records;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns how many bytes were dropped while looking for a frame
+    @return Skipped bytes since construction or reset()
+*/
+/**************************************************************************/
+uint32_t INA228_LogDecoder::skippedBytes(void) const {
+  return _skipped;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads a header. The values are taken from the next keyframe on.
+    @param data
+          The bytes, starting with the header tag
+    @param len
+          Number of bytes available
+    @param used
+          Set to the bytes used
+    @return INA228_LOG_CONFIG, or how the header failed
+*/
+/**************************************************************************/
+INA228_LogStatus INA228_LogDecoder::_header(const uint8_t* data, size_t len,
+                                            size_t& used) {
+  if (len < INA228_LOG_HEADER_SIZE) {
+    return INA228_LOG_MORE;
+  }
+  if (INA228_LogFormat::crc8(data, INA228_LOG_HEADER_SIZE - 1) !=
+          data[INA228_LOG_HEADER_SIZE - 1] ||
+      data[1] != INA228_LOG_VERSION) {
+    return _skip(1, used);
+  }
+  _channels = data[2] & ((1 << INA228_LOG_CHANNELS) - 1);
+  _range = data[3] & 1;
+  _current_lsb = INA228_LogFormat::getFloat(data + 5);
+  _shunt_res = INA228_LogFormat::getFloat(data + 9);
+  _configured = true;
+  _synced = false;
+  used = INA228_LOG_HEADER_SIZE;
+  return INA228_LOG_CONFIG;
+}
+
+/**************************************************************************/
+/*!
+    @brief Parses the varints of a frame without applying them
+    @param data
+          The bytes, starting with the tag
+    @param len
+          Number of bytes available
+    @param values
+          Set to the timestamp field, then one signed value per channel
+          bit, channels not in the log left alone
+    @param keyframe
+          True if the tag is a keyframe, whose CRC is checked
+    @return Frame length, 0 if it is incomplete, -1 if it is damaged
+*/
+/**************************************************************************/
+int16_t INA228_LogDecoder::_frame(const uint8_t* data, size_t len,
+                                  int64_t* values, bool keyframe) {
+  const uint8_t* end = data + len;
+  const uint8_t* p = data + 1;
+  uint64_t raw;
+
+  if (keyframe || data[0] == INA228_LOG_DELTA_LONG) {
+    int8_t n = INA228_LogFormat::getVarint(p, end, raw);
+    if (n <= 0) {
+      return n;
+    }
+    p += n;
+  } else {
+    raw = data[0];
+  }
+  values[0] = keyframe ? (int64_t)raw : INA228_LogFormat::unzigzag(raw);
+
+  for (uint8_t i = 0; i < INA228_LOG_CHANNELS; i++) {
+    if (!(_channels & (1 << i))) {
+      continue;
+    }
+    int8_t n = INA228_LogFormat::getVarint(p, end, raw);
+    if (n <= 0) {
+      return n;
+    }
+    p += n;
+    values[i + 1] = INA228_LogFormat::unzigzag(raw);
+  }
+
+  if (keyframe) {
+    if (p >= end) {
+      return 0;
+    }
+    if (INA228_LogFormat::crc8(data, p - data) != *p) {
+      return -1;
+    }
+    p++;
+  }
+  return p - data;
+}
+
+/**************************************************************************/
+/*!
+    @brief Scales the last raw values into a record
+    @param record
+          The record to fill
+    @param timestamp_us
+          Timestamp of the frame
+    @param keyframe
+          True if the frame was a keyframe
+*/
+/**************************************************************************/
+void INA228_LogDecoder::_fill(INA228_LogRecord& record, uint32_t timestamp_us,
+                              bool keyframe) {
+  record.timestamp_us = timestamp_us;
+  record.mask = _channels;
+  record.keyframe = keyframe;
+  record.shunt_voltage_raw = (int32_t)_previous[0];
+  record.bus_voltage_raw = (uint32_t)_previous[1];
+  record.die_temp_raw = (int16_t)_previous[2];
+  record.current_raw = (int32_t)_previous[3];
+  record.power_raw = (uint32_t)_previous[4];
+  record.energy_raw = (uint64_t)_previous[5];
+  record.charge_raw = _previous[6];
+
+  typedef INA228_Traits T;
+  double shunt_lsb_mV = traitsLsb(
+      T::shunt_lsb_nV,
+      _range ? T::shunt_lsb_shift_range1 : T::shunt_lsb_shift, 1e6);
+  double lsb = _current_lsb;
+  double power_lsb = T::powerLsbFactor() * lsb;
+  record.shunt_voltage_mV = record.shunt_voltage_raw * shunt_lsb_mV;
+  record.bus_voltage_V =
+      record.bus_voltage_raw * traitsLsb(T::bus_lsb_uV, T::bus_lsb_shift, 1e6);
+  record.die_temp_C =
+      record.die_temp_raw * traitsLsb(T::temp_lsb_mC, T::temp_lsb_shift, 1e3);
+  record.current_mA = record.current_raw * lsb * 1000;
+  record.power_mW = record.power_raw * power_lsb * 1000;
+  // ENERGY counts 16 power LSBs
+  record.energy_J = record.energy_raw * 16 * power_lsb;
+  record.charge_C = record.charge_raw * lsb;
+}
+
+/**************************************************************************/
+/*!
+    @brief Drops bytes that don't make a usable frame. Deltas can't be
+    trusted after that, so the decoder waits for the next keyframe.
+    @param bytes
+          Number of bytes to drop
+    @param used
+          Set to bytes
+    @return INA228_LOG_SKIPPED
+*/
+/**************************************************************************/
+INA228_LogStatus INA228_LogDecoder::_skip(size_t bytes, size_t& used) {
+  _skipped += bytes;
+  _synced = false;
+  used = bytes;
+  return INA228_LOG_SKIPPED;
+}
@@ -0,0 +1,103 @@
+/*!
+ *  @file Adafruit_INA228_LogDecoder.h
+ *
+ * 	Decoder for the packed binary INA228 log format. Plain C++, so logs
+ * 	can be read back on a Linux host as well as on the board.
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_LOGDECODER_H
+#define _ADAFRUIT_INA228_LOGDECODER_H
+
+#include "Adafruit_INA228_LogFormat.h"
+
+/**
+ * @brief Outcome of INA228_LogDecoder::decode.
+ */
+typedef enum _log_status {
+  INA228_LOG_RECORD,  ///< A frame was decoded into the record
+  INA228_LOG_CONFIG,  ///< A header was read, the record is unchanged
+  INA228_LOG_SKIPPED, ///< Bytes were dropped: damaged, unknown or unsynced
+  INA228_LOG_MORE,    ///< The frame is incomplete, nothing was used
+} INA228_LogStatus;
+
+/**
+ * @brief One decoded frame. Raw values match INA228_Snapshot, the scaled
+ * ones are doubles since a host has them to spare.
+ */
+typedef struct {
+  int64_t charge_raw;        ///< CHARGE, 40-bit two's complement
+  uint64_t energy_raw;       ///< ENERGY, 40-bit unsigned
+  uint32_t timestamp_us;     ///< micros() of the snapshot
+  int32_t shunt_voltage_raw; ///< VSHUNT, 20-bit two's complement
+  uint32_t bus_voltage_raw;  ///< VBUS, 20-bit unsigned
+  int32_t current_raw;       ///< CURRENT, 20-bit two's complement
+  uint32_t power_raw;        ///< POWER, 24-bit unsigned
+  int16_t die_temp_raw;      ///< DIETEMP, 16-bit two's complement
+  uint8_t mask;              ///< INA228_Channel bits in the frame
+  bool keyframe;             ///< True if the frame was a keyframe
+  double shunt_voltage_mV;   ///< Shunt voltage in mV
+  double bus_voltage_V;      ///< Bus voltage in V
+  double die_temp_C;         ///< Die temperature in deg C
+  double current_mA;         ///< Current in mA
+  double power_mW;           ///< Power in mW
+  double energy_J;           ///< Energy in Joules
+  double charge_C;           ///< Charge in Coulombs
+} INA228_LogRecord;
+
+/*!
+ *    @brief  Reads frames back from any chunk of a log, such as a block
+ *            read from a file or a serial buffer. Allocates nothing and
+ *            keeps only the last raw values.
+ *
+ *    Feed it bytes with decode() and advance by the count it reports
+ *    used. A reader that starts mid-stream skips frames until it has
+ *    seen a header and a keyframe. The encoder repeats the header every
+ *    INA228_LOG_HEADER_REPEAT keyframes, so that is never far off.
+ */
+class INA228_LogDecoder {
+ public:
+  INA228_LogDecoder();
+
+  INA228_LogStatus decode(const uint8_t* data, size_t len, size_t& used,
+                          INA228_LogRecord& record);
+  void reset(void);
+
+  uint8_t channels(void) const;
+  uint8_t adcRange(void) const;
+  float currentLSB(void) const;
+  float shuntResistance(void) const;
+  uint32_t records(void) const;
+  uint32_t skippedBytes(void) const;
+
+ private:
+  INA228_LogStatus _header(const uint8_t* data, size_t len, size_t& used);
+  int16_t _frame(const uint8_t* data, size_t len, int64_t* values,
+                 bool keyframe);
+  void _fill(INA228_LogRecord& record, uint32_t timestamp_us, bool keyframe);
+  INA228_LogStatus _skip(size_t bytes, size_t& used);
+
+  int64_t _previous[INA228_LOG_CHANNELS]; ///< Raw values of the last frame
+  int64_t _slope[2];      ///< Last ENERGY and CHARGE change
+  int32_t _last_delta_us; ///< Timestamp change of the last frame
+  uint32_t _last_us;      ///< Timestamp of the last frame
+  uint32_t _records;      ///< Frames decoded
+  uint32_t _skipped;      ///< Bytes dropped
+  float _current_lsb;     ///< A per CURRENT LSB, from the header
+  float _shunt_res;       ///< Shunt resistance in ohms, from the header
+  uint8_t _channels;      ///< INA228_Channel bits per frame, from the header
+  uint8_t _range;         ///< Shunt ADC range, from the header
+  bool _configured;       ///< True once a header was read
+  bool _synced;           ///< True once a keyframe was read
+};
+
+#endif
@@ -0,0 +1,233 @@
+/*!
+ *  @file Adafruit_INA228_LogEncoder.cpp
+ *
+ * 	Streaming encoder for the packed binary INA228 log format
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_INA228_LogEncoder.h"
+
+/*!
+ *    @brief  Instantiates an encoder
+ *    @param  channels
+ *            INA228_Channel bits stored in every frame. Snapshots have to
+ *            hold all of them.
+ *    @param  keyframe_interval
+ *            Frames from one keyframe to the next, 1 for keyframes only.
+ *            A reader that starts mid-stream or hits a damaged frame picks
+ *            up again at the next keyframe.
+ */
+INA228_LogEncoder::INA228_LogEncoder(uint8_t channels,
+                                     uint8_t keyframe_interval)
+    : _last_delta_us(0),
+      _last_us(0),
+      _frames(0),
+      _channels(channels & INA228_CHANNEL_ALL),
+      _interval(keyframe_interval ? keyframe_interval : 1),
+      _since_key(0),
+      _keys_left(0),
+      _has_header(false) {}
+
+/**************************************************************************/
+/*!
+    @brief Builds a header with the calibration the raw values need. The
+    frame after it is a keyframe.
+    @param ina228
+          The sensor being logged. Its ADC range is read, from the
+          register cache if enabled.
+    @param buffer
+          Receives INA228_LOG_HEADER_SIZE bytes
+    @return Bytes written
+*/
+/**************************************************************************/
+uint8_t INA228_LogEncoder::header(Adafruit_INA228& ina228, uint8_t* buffer) {
+  buffer[0] = INA228_LOG_HEADER;
+  buffer[1] = INA228_LOG_VERSION;
+  buffer[2] = _channels;
+  buffer[3] = ina228.getADCRange();
+  buffer[4] = _interval;
+  INA228_LogFormat::putFloat(buffer + 5, ina228.getCurrentLSB());
+  INA228_LogFormat::putFloat(buffer + 9, ina228.getShuntResistance());
+  buffer[13] = INA228_LogFormat::crc8(buffer, 13);
+  memcpy(_header, buffer, INA228_LOG_HEADER_SIZE);
+  _has_header = true;
+  _keys_left = INA228_LOG_HEADER_REPEAT;
+  keyframe();
+  return INA228_LOG_HEADER_SIZE;
+}
+
+/**************************************************************************/
+/*!
+    @brief Encodes a snapshot as a keyframe or a delta frame. Every
+    INA228_LOG_HEADER_REPEAT keyframes the last header goes in front.
+    @param snapshot
+          The reading, holding every channel of the encoder
+    @param buffer
+          Receives up to INA228_LOG_MAX_FRAME bytes
+    @return Bytes written, 0 if the snapshot lacks a channel
+*/
+/**************************************************************************/
+uint8_t INA228_LogEncoder::encode(const INA228_Snapshot& snapshot,
+                                  uint8_t* buffer) {
+  if ((snapshot.mask & _channels) != _channels) {
+    return 0;
+  }
+  const int64_t values[INA228_LOG_CHANNELS] = {
+      snapshot.shunt_voltage_raw, snapshot.bus_voltage_raw,
+      snapshot.die_temp_raw,      snapshot.current_raw,
+      snapshot.power_raw,         (int64_t)snapshot.energy_raw,
+      snapshot.charge_raw};
+
+  uint8_t* end;
+  if (_since_key) {
+    end = _delta(values, snapshot.timestamp_us, buffer);
+  } else {
+    uint8_t* p = buffer;
+    if (_has_header && !_keys_left) {
+      memcpy(p, _header, INA228_LOG_HEADER_SIZE);
+      p += INA228_LOG_HEADER_SIZE;
+      _keys_left = INA228_LOG_HEADER_REPEAT;
+    }
+    _keys_left--;
+    end = _keyframe(values, snapshot.timestamp_us, p);
+  }
+  _since_key = (_since_key + 1) % _interval;
+  _last_us = snapshot.timestamp_us;
+  _frames++;
+  return end - buffer;
+}
+
+#if defined(ARDUINO)
+/**************************************************************************/
+/*!
+    @brief Writes a header to a stream
+    @param out
+          The stream, such as an SD File or Serial
+    @param ina228
+          The sensor being logged
+    @return Bytes written
+*/
+/**************************************************************************/
+size_t INA228_LogEncoder::writeHeader(Print& out, Adafruit_INA228& ina228) {
+  uint8_t buffer[INA228_LOG_HEADER_SIZE];
+  return out.write(buffer, header(ina228, buffer));
+}
+
+/**************************************************************************/
+/*!
+    @brief Encodes a snapshot and writes the frame to a stream
+    @param out
+          The stream, such as an SD File or Serial
+    @param snapshot
+          The reading, holding every channel of the encoder
+    @return Bytes written, 0 if the snapshot lacks a channel
+*/
+/**************************************************************************/
+size_t INA228_LogEncoder::write(Print& out, const INA228_Snapshot& snapshot) {
+  uint8_t buffer[INA228_LOG_MAX_FRAME];
+  uint8_t len = encode(snapshot, buffer);
+  return len ? out.write(buffer, len) : 0;
+}
+#endif
+
+/**************************************************************************/
+/*!
+    @brief Makes the next frame a keyframe, for example at the start of a
+    new file or after a write error
+*/
+/**************************************************************************/
+void INA228_LogEncoder::keyframe(void) {
+  _since_key = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the number of frames encoded
+    @return Frame count since construction, headers not included
+*/
+/**************************************************************************/
+uint32_t INA228_LogEncoder::frames(void) const {
+  return _frames;
+}
+
+/**************************************************************************/
+/*!
+    @brief Writes a keyframe with the absolute values and restarts the
+    delta chains from it
+    @param values
+          Raw value per channel bit
+    @param timestamp_us
+          Timestamp of the snapshot
+    @param out
+          Receives the frame
+    @return End of the frame
+*/
+/**************************************************************************/
+uint8_t* INA228_LogEncoder::_keyframe(const int64_t* values,
+                                      uint32_t timestamp_us, uint8_t* out) {
+  uint8_t* p = out;
+  *p++ = INA228_LOG_KEYFRAME;
+  p += INA228_LogFormat::putVarint(p, timestamp_us);
+  for (uint8_t i = 0; i < INA228_LOG_CHANNELS; i++) {
+    if (_channels & (1 << i)) {
+      p += INA228_LogFormat::putVarint(p, INA228_LogFormat::zigzag(values[i]));
+      _previous[i] = values[i];
+    }
+  }
+  *p = INA228_LogFormat::crc8(out, p - out);
+  _slope[0] = _slope[1] = 0;
+  _last_delta_us = 0;
+  return p + 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief Writes a delta frame. The timestamp, ENERGY and CHARGE store
+    the change of their change, the other channels the change.
+    @param values
+          Raw value per channel bit
+    @param timestamp_us
+          Timestamp of the snapshot
+    @param out
+          Receives the frame
+    @return End of the frame
+*/
+/**************************************************************************/
+uint8_t* INA228_LogEncoder::_delta(const int64_t* values,
+                                   uint32_t timestamp_us, uint8_t* out) {
+  uint8_t* p = out;
+  int32_t delta_us = (int32_t)(timestamp_us - _last_us);
+  uint64_t dod = INA228_LogFormat::zigzag((int64_t)delta_us - _last_delta_us);
+  _last_delta_us = delta_us;
+  // a steady sample rate leaves a small delta-of-delta, kept in the tag
+  if (dod < INA228_LOG_DELTA_LONG) {
+    *p++ = (uint8_t)dod;
+  } else {
+    *p++ = INA228_LOG_DELTA_LONG;
+    p += INA228_LogFormat::putVarint(p, dod);
+  }
+  for (uint8_t i = 0; i < INA228_LOG_CHANNELS; i++) {
+    if (!(_channels & (1 << i))) {
+      continue;
+    }
+    int64_t change = values[i] - _previous[i];
+    _previous[i] = values[i];
+    if ((1 << i) & INA228_LOG_ACCUMULATORS) {
+      int64_t& slope = _slope[i - 5];
+      int64_t curve = change - slope;
+      slope = change;
+      change = curve;
+    }
+    p += INA228_LogFormat::putVarint(p, INA228_LogFormat::zigzag(change));
+  }
+  return p;
+}
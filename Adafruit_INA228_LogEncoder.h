@@ -0,0 +1,70 @@
+/*!
+ *  @file Adafruit_INA228_LogEncoder.h
+ *
+ * 	Streaming encoder for the packed binary INA228 log format
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_LOGENCODER_H
+#define _ADAFRUIT_INA228_LOGENCODER_H
+
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_LogFormat.h"
+
+/*!
+ *    @brief  Turns snapshots into frames of the format described in
+ *            Adafruit_INA228_LogFormat.h. Keeps only the last raw values,
+ *            so it allocates nothing and a frame costs a few shifts per
+ *            channel. A typical delta frame of all seven channels takes 10
+ *            to 15 bytes.
+ *
+ *    Frames go into a caller buffer of INA228_LOG_MAX_FRAME bytes, or
+ *    straight to a Print such as an SD File or Serial. Write a header first
+ *    and again whenever the shunt, calibration or ADC range change. The
+ *    encoder keeps a copy and repeats it every INA228_LOG_HEADER_REPEAT
+ *    keyframes, for readers that start mid-stream.
+ */
+class INA228_LogEncoder {
+ public:
+  INA228_LogEncoder(uint8_t channels = INA228_CHANNEL_ALL,
+                    uint8_t keyframe_interval = 64);
+
+  uint8_t header(Adafruit_INA228& ina228, uint8_t* buffer);
+  uint8_t encode(const INA228_Snapshot& snapshot, uint8_t* buffer);
+#if defined(ARDUINO)
+  size_t writeHeader(Print& out, Adafruit_INA228& ina228);
+  size_t write(Print& out, const INA228_Snapshot& snapshot);
+#endif
+  void keyframe(void);
+  uint32_t frames(void) const;
+
+ private:
+  uint8_t* _keyframe(const int64_t* values, uint32_t timestamp_us,
+                     uint8_t* out);
+  uint8_t* _delta(const int64_t* values, uint32_t timestamp_us,
+                  uint8_t* out);
+
+  int64_t _previous[INA228_LOG_CHANNELS]; ///< Raw values of the last frame
+  int64_t _slope[2];      ///< Last ENERGY and CHARGE change
+  int32_t _last_delta_us; ///< Timestamp change of the last frame
+  uint32_t _last_us;      ///< Timestamp of the last frame
+  uint32_t _frames;       ///< Frames encoded
+  uint8_t _channels;      ///< INA228_Channel bits in every frame
+  uint8_t _interval;      ///< Frames from one keyframe to the next
+  uint8_t _since_key;     ///< Frames since the last keyframe, 0 for next
+  uint8_t _keys_left;     ///< Keyframes until the header is repeated
+  bool _has_header;       ///< True once header() filled _header
+
+  uint8_t _header[INA228_LOG_HEADER_SIZE]; ///< Last header, repeated
+};
+
+#endif
@@ -0,0 +1,182 @@
+/*!
+ *  @file Adafruit_INA228_LogFormat.h
+ *
+ * 	Packed binary log format for INA228 readings, shared by the encoder
+ *  and the decoder
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_LOGFORMAT_H
+#define _ADAFRUIT_INA228_LOGFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * A log is a sequence of frames, each starting with a tag byte:
+ *
+ *   0x00-0x7E  delta frame, the tag is the zigzag timestamp delta-of-delta
+ *   0x7F       delta frame, the delta-of-delta follows as a varint
+ *   0xA5       keyframe: varint timestamp, one zigzag varint per channel
+ *              with the absolute raw value, CRC-8 of the frame
+ *   0xA6       header: version, channels, ADC range, keyframe interval,
+ *              current LSB and shunt resistance as little-endian floats,
+ *              CRC-8 of the frame
+ *
+ * A log starts with a header, and the encoder repeats it ahead of every
+ * INA228_LOG_HEADER_REPEAT-th keyframe so a reader that joins late can
+ * still scale the values. Delta frames hold one zigzag varint per
+ * channel, in INA228_Channel bit order: the change since the last frame,
+ * and for ENERGY and CHARGE the change of that change, since both climb at
+ * a steady rate. Keyframes let a reader start or resync mid-stream. Only
+ * headers and keyframes carry a CRC, so a damaged delta frame can throw the
+ * values off until the next keyframe.
+ */
+
+#define INA228_LOG_VERSION 1        ///< Format version in the header
+#define INA228_LOG_CHANNELS 7       ///< Channels a frame can hold
+#define INA228_LOG_DELTA_LONG 0x7F  ///< Tag of a delta frame with long dod
+#define INA228_LOG_KEYFRAME 0xA5    ///< Tag of a keyframe
+#define INA228_LOG_HEADER 0xA6      ///< Tag of a header
+#define INA228_LOG_HEADER_SIZE 14   ///< Bytes in a header, tag included
+#define INA228_LOG_MAX_FRAME 95     ///< Most bytes one encode() writes
+#define INA228_LOG_VARINT_MAX 10    ///< Longest varint in bytes
+#define INA228_LOG_ACCUMULATORS 0x60 ///< ENERGY and CHARGE channel bits
+
+#ifndef INA228_LOG_HEADER_REPEAT
+#define INA228_LOG_HEADER_REPEAT 8 ///< Keyframes from one header to the next
+#endif
+
+/*!
+ *    @brief  Varint, zigzag and checksum helpers of the log format. Plain
+ *            C++, so the decoder builds on a host without Arduino.
+ */
+class INA228_LogFormat {
+ public:
+  /*!
+   *    @brief  Writes an unsigned value 7 bits per byte, low bits first,
+   *            with the top bit set on all but the last byte
+   *    @param  out
+   *            Receives up to INA228_LOG_VARINT_MAX bytes
+   *    @param  value
+   *            The value
+   *    @return Bytes written
+   */
+  static uint8_t putVarint(uint8_t* out, uint64_t value) {
+    uint8_t len = 0;
+    while (value >= 0x80) {
+      out[len++] = (uint8_t)value | 0x80;
+      value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+    return len;
+  }
+
+  /*!
+   *    @brief  Reads a varint
+   *    @param  in
+   *            First byte of the varint
+   *    @param  end
+   *            End of the available bytes
+   *    @param  value
+   *            Set to the value
+   *    @return Bytes read, 0 if the data ends first, -1 if it is malformed
+   */
+  static int8_t getVarint(const uint8_t* in, const uint8_t* end,
+                          uint64_t& value) {
+    value = 0;
+    for (uint8_t i = 0; i < INA228_LOG_VARINT_MAX; i++) {
+      if (in + i >= end) {
+        return 0;
+      }
+      value |= (uint64_t)(in[i] & 0x7F) << (7 * i);
+      if (!(in[i] & 0x80)) {
+        return i + 1;
+      }
+    }
+    return -1;
+  }
+
+  /*!
+   *    @brief  Maps signed to unsigned so small magnitudes stay small:
+   *            0, -1, 1, -2 become 0, 1, 2, 3
+   *    @param  value
+   *            The signed value
+   *    @return The zigzag encoded value
+   */
+  static uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+  }
+
+  /*!
+   *    @brief  Undoes zigzag()
+   *    @param  value
+   *            The zigzag encoded value
+   *    @return The signed value
+   */
+  static int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+  }
+
+  /*!
+   *    @brief  CRC-8 with polynomial 0x07, guarding headers and keyframes
+   *    @param  data
+   *            The bytes
+   *    @param  len
+   *            Number of bytes
+   *    @return The checksum
+   */
+  static uint8_t crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+      crc ^= *data++;
+      for (uint8_t bit = 0; bit < 8; bit++) {
+        crc = crc & 0x80 ? (uint8_t)(crc << 1) ^ 0x07 : crc << 1;
+      }
+    }
+    return crc;
+  }
+
+  /*!
+   *    @brief  Writes a float as 4 little-endian bytes
+   *    @param  out
+   *            Receives the bytes
+   *    @param  value
+   *            The value, IEEE 754 single precision on every target
+   */
+  static void putFloat(uint8_t* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    for (uint8_t i = 0; i < 4; i++) {
+      out[i] = bits >> (8 * i);
+    }
+  }
+
+  /*!
+   *    @brief  Reads a float written by putFloat()
+   *    @param  in
+   *            The 4 bytes
+   *    @return The value
+   */
+  static float getFloat(const uint8_t* in) {
+    uint32_t bits = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+      bits |= (uint32_t)in[i] << (8 * i);
+    }
+    float value;
+    memcpy(&value, &bits, 4);
+    return value;
+  }
+};
+
+#endif
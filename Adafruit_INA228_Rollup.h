@@ -0,0 +1,322 @@
+/*!
+ *  @file Adafruit_INA228_Rollup.h
+ *
+ * 	Fixed-size second, minute and hour history of INA228 readings
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_ROLLUP_H
+#define _ADAFRUIT_INA228_ROLLUP_H
+
+#include "Adafruit_INA228.h"
+
+/**
+ * @brief Tiers of an INA228_Rollup, each with its own slot length.
+ */
+typedef enum _rollup_tier {
+  INA228_ROLLUP_SECONDS, ///< 1 s slots
+  INA228_ROLLUP_MINUTES, ///< 60 s slots
+  INA228_ROLLUP_HOURS,   ///< 3600 s slots
+} INA228_RollupTier;
+
+/**
+ * @brief Summary of the readings that fell into one slot.
+ */
+typedef struct {
+  uint32_t start_s;   ///< Start of the slot in rollup time, see now()
+  uint32_t count;     ///< Samples in the slot
+  float current_min;  ///< Lowest current in mA
+  float current_max;  ///< Highest current in mA
+  float current_mean; ///< Average current in mA
+  float power_min;    ///< Lowest power in mW
+  float power_max;    ///< Highest power in mW
+  float power_mean;   ///< Average power in mW
+  float energy_J;     ///< Energy used during the slot in J
+} INA228_RollupSlot;
+
+/*!
+ *    @brief  Keeps a history of current, power and energy in three rings
+ *            of slots: SECONDS 1 s slots, MINUTES 1 min slots and HOURS 1 h
+ *            slots. Every sample updates the open slot of each tier, so no
+ *            raw samples are kept and the size is fixed at compile time:
+ *            36 bytes per slot plus an open slot per tier, so about 5.3 kB
+ *            for the default 60/60/24. That is more RAM than an AVR such
+ *            as the Uno has; pick smaller tiers there.
+ *
+ *    Time is counted in seconds from the snapshot timestamps, so samples
+ *    have to come at least once per micros() wrap, about 71 minutes.
+ *    setTime() moves the count to a wall clock, such as Unix time from an
+ *    RTC, which query() then takes too. Slots without samples are skipped,
+ *    so after a gap a ring reaches further back.
+ *
+ *    Energy comes from the ENERGY register when the snapshots hold it, and
+ *    from power times the time between samples otherwise. Feed snapshots
+ *    with the same channels throughout, the means count every sample.
+ */
+template <uint16_t SECONDS = 60, uint16_t MINUTES = 60, uint16_t HOURS = 24>
+class INA228_Rollup {
+  static_assert(SECONDS && MINUTES && HOURS, "every tier needs a slot");
+
+ public:
+  /*!
+   *    @brief  Instantiates an empty history starting at time 0
+   */
+  INA228_Rollup()
+      : _time_s(0), _time_us(0), _last_us(0), _last_energy(0),
+        _started(false) {
+    _seconds.clear();
+    _minutes.clear();
+    _hours.clear();
+  }
+
+  /*!
+   *    @brief  Adds a reading to the open slot of every tier, closing the
+   *            slots its time has moved past
+   *    @param  snapshot
+   *            A reading holding CURRENT, POWER or both. ENERGY is used
+   *            for the energy deltas if present.
+   */
+  void add(const INA228_Snapshot& snapshot) {
+    uint32_t elapsed_us = _started ? snapshot.timestamp_us - _last_us : 0;
+    _last_us = snapshot.timestamp_us;
+    _time_us += elapsed_us;
+    _time_s += _time_us / 1000000UL;
+    _time_us %= 1000000UL;
+
+    float energy_J = 0;
+    if (snapshot.mask & INA228_CHANNEL_ENERGY) {
+      // a drop means the accumulator was reset, it counts from zero
+      uint64_t delta = snapshot.energy_raw >= _last_energy
+                           ? snapshot.energy_raw - _last_energy
+                           : snapshot.energy_raw;
+      if (_started && snapshot.energy_raw) {
+        // energy_J is the register scaled, so the ratio is J per LSB
+        energy_J = (float)delta * (snapshot.energy_J / snapshot.energy_raw);
+      }
+      _last_energy = snapshot.energy_raw;
+    } else if (snapshot.mask & INA228_CHANNEL_POWER) {
+      energy_J = snapshot.power_mW * 1e-9f * elapsed_us;
+    }
+    _started = true;
+
+    _seconds.add(snapshot, energy_J, _time_s, 1);
+    _minutes.add(snapshot, energy_J, _time_s, 60);
+    _hours.add(snapshot, energy_J, _time_s, 3600);
+  }
+
+  /*!
+   *    @brief  Sets the current time. Slots started before stay where they
+   *            are, so set it before the first sample or move it forward.
+   *    @param  seconds
+   *            The time of the latest sample in seconds, on any time base
+   */
+  void setTime(uint32_t seconds) {
+    _time_s = seconds;
+  }
+
+  /*!
+   *    @brief  Returns the time of the latest sample
+   *    @return Seconds since construction or the base given to setTime()
+   */
+  uint32_t now(void) const {
+    return _time_s;
+  }
+
+  /*!
+   *    @brief  Copies the closed slots of a tier that start within a time
+   *            range, oldest first
+   *    @param  tier
+   *            The tier to read
+   *    @param  from_s
+   *            Earliest slot start to include
+   *    @param  to_s
+   *            Slots starting at or after this are left out
+   *    @param  slots
+   *            Receives the slots
+   *    @param  max
+   *            Size of slots
+   *    @return Number of slots copied
+   */
+  uint16_t query(INA228_RollupTier tier, uint32_t from_s, uint32_t to_s,
+                 INA228_RollupSlot* slots, uint16_t max) const {
+    switch (tier) {
+    case INA228_ROLLUP_SECONDS:
+      return _seconds.query(from_s, to_s, slots, max);
+    case INA228_ROLLUP_MINUTES:
+      return _minutes.query(from_s, to_s, slots, max);
+    default:
+      return _hours.query(from_s, to_s, slots, max);
+    }
+  }
+
+  /*!
+   *    @brief  Returns the slot of a tier still taking samples
+   *    @param  tier
+   *            The tier
+   *    @return The open slot, count is 0 before the first sample
+   */
+  const INA228_RollupSlot& openSlot(INA228_RollupTier tier) const {
+    switch (tier) {
+    case INA228_ROLLUP_SECONDS:
+      return _seconds.open;
+    case INA228_ROLLUP_MINUTES:
+      return _minutes.open;
+    default:
+      return _hours.open;
+    }
+  }
+
+  /*!
+   *    @brief  Returns how many closed slots a tier holds
+   *    @param  tier
+   *            The tier
+   *    @return Slot count, up to the capacity of the tier
+   */
+  uint16_t count(INA228_RollupTier tier) const {
+    switch (tier) {
+    case INA228_ROLLUP_SECONDS:
+      return _seconds.count;
+    case INA228_ROLLUP_MINUTES:
+      return _minutes.count;
+    default:
+      return _hours.count;
+    }
+  }
+
+  /*!
+   *    @brief  Forgets all slots, the time keeps running
+   */
+  void clear(void) {
+    _seconds.clear();
+    _minutes.clear();
+    _hours.clear();
+  }
+
+ private:
+  /*!
+   *    @brief  Ring of closed slots plus the open one of one tier
+   */
+  template <uint16_t N> struct Tier {
+    INA228_RollupSlot slots[N]; ///< Closed slots, oldest at head
+    INA228_RollupSlot open;     ///< Slot taking samples
+    uint16_t head;              ///< Index of the oldest closed slot
+    uint16_t count;             ///< Closed slots held
+
+    /*!
+     *    @brief  Empties the tier
+     */
+    void clear(void) {
+      head = 0;
+      count = 0;
+      open.count = 0;
+    }
+
+    /*!
+     *    @brief  Adds a sample, closing the open slot first if the sample
+     *            belongs to a later one
+     *    @param  s
+     *            The reading
+     *    @param  energy_J
+     *            Energy since the previous reading
+     *    @param  time_s
+     *            Time of the reading
+     *    @param  width_s
+     *            Slot length of the tier
+     */
+    void add(const INA228_Snapshot& s, float energy_J, uint32_t time_s,
+             uint32_t width_s) {
+      uint32_t start = time_s - time_s % width_s;
+      if (open.count && open.start_s != start) {
+        slots[(head + count) % N] = open;
+        if (count < N) {
+          count++;
+        } else {
+          head = (head + 1) % N;
+        }
+        open.count = 0;
+      }
+      if (!open.count) {
+        bool current = s.mask & INA228_CHANNEL_CURRENT;
+        bool power = s.mask & INA228_CHANNEL_POWER;
+        open.start_s = start;
+        open.current_min = open.current_max = current ? s.current_mA : 0;
+        open.power_min = open.power_max = power ? s.power_mW : 0;
+        open.current_mean = open.power_mean = open.energy_J = 0;
+      }
+      open.count++;
+      open.energy_J += energy_J;
+      if (s.mask & INA228_CHANNEL_CURRENT) {
+        _update(open.current_min, open.current_max, open.current_mean,
+                s.current_mA);
+      }
+      if (s.mask & INA228_CHANNEL_POWER) {
+        _update(open.power_min, open.power_max, open.power_mean, s.power_mW);
+      }
+    }
+
+    /*!
+     *    @brief  Folds a value into min, max and the running mean
+     *    @param  min
+     *            Lowest value so far
+     *    @param  max
+     *            Highest value so far
+     *    @param  mean
+     *            Mean of the open.count - 1 earlier values
+     *    @param  value
+     *            The new value
+     */
+    void _update(float& min, float& max, float& mean, float value) {
+      if (value < min) {
+        min = value;
+      }
+      if (value > max) {
+        max = value;
+      }
+      mean += (value - mean) / open.count;
+    }
+
+    /*!
+     *    @brief  Copies the closed slots starting within a range
+     *    @param  from_s
+     *            Earliest start to include
+     *    @param  to_s
+     *            First start to leave out
+     *    @param  out
+     *            Receives the slots, oldest first
+     *    @param  max
+     *            Size of out
+     *    @return Number of slots copied
+     */
+    uint16_t query(uint32_t from_s, uint32_t to_s, INA228_RollupSlot* out,
+                   uint16_t max) const {
+      uint16_t copied = 0;
+      for (uint16_t i = 0; i < count && copied < max; i++) {
+        const INA228_RollupSlot& slot = slots[(head + i) % N];
+        if (slot.start_s >= from_s && slot.start_s < to_s) {
+          out[copied++] = slot;
+        }
+      }
+      return copied;
+    }
+  };
+
+  Tier<SECONDS> _seconds; ///< 1 s slots
+  Tier<MINUTES> _minutes; ///< 1 min slots
+  Tier<HOURS> _hours;     ///< 1 h slots
+  uint32_t _time_s;       ///< Whole seconds of the latest sample
+  uint32_t _time_us;      ///< Microseconds past _time_s
+  uint32_t _last_us;      ///< Timestamp of the latest snapshot
+  uint64_t _last_energy;  ///< ENERGY register of the latest snapshot
+  bool _started;          ///< True once a sample was added
+};
+
+#endif
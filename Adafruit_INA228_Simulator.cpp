@@ -0,0 +1,818 @@
+/*!
+ *  @file Adafruit_INA228_Simulator.cpp
+ *
+ * 	Register-level model of the INA228, for running the driver without
+ *  hardware
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_INA228_Simulator.h"
+
+#include <math.h>
+
+// Register addresses, duplicated so the model doesn't depend on the driver
+#define SIM_REG_CONFIG 0x00
+#define SIM_REG_ADCCFG 0x01
+#define SIM_REG_SHUNTCAL 0x02
+#define SIM_REG_SHUNTTEMPCO 0x03
+#define SIM_REG_VSHUNT 0x04
+#define SIM_REG_VBUS 0x05
+#define SIM_REG_DIETEMP 0x06
+#define SIM_REG_CURRENT 0x07
+#define SIM_REG_POWER 0x08
+#define SIM_REG_ENERGY 0x09
+#define SIM_REG_CHARGE 0x0A
+#define SIM_REG_DIAGALRT 0x0B
+#define SIM_REG_SOVL 0x0C
+#define SIM_REG_SUVL 0x0D
+#define SIM_REG_BOVL 0x0E
+#define SIM_REG_BUVL 0x0F
+#define SIM_REG_TEMPLIMIT 0x10
+#define SIM_REG_PWRLIMIT 0x11
+#define SIM_REG_MFG_UID 0x3E
+#define SIM_REG_DVC_UID 0x3F
+
+// DIAG_ALRT bits
+#define SIM_ALATCH 15
+#define SIM_CNVR 14
+#define SIM_ENERGYOF 11
+#define SIM_CHARGEOF 10
+#define SIM_MATHOF 9
+#define SIM_TMPOL 7
+#define SIM_SHNTOL 6
+#define SIM_SHNTUL 5
+#define SIM_BUSOL 4
+#define SIM_BUSUL 3
+#define SIM_POL 2
+#define SIM_CNVRF 1
+#define SIM_LIMIT_FLAGS 0x00FC
+
+#define SIM_FULL_SCALE_20 0x7FFFF // largest positive 20-bit result
+#define SIM_ACCUMULATOR_RANGE 1099511627776.0 // 2^40
+
+/*!
+ *    @brief  Instantiates a simulated INA228 in its power-on state
+ *    @param  i2c_addr
+ *            The address the device answers on
+ */
+INA228_Simulator::INA228_Simulator(uint8_t i2c_addr)
+    : _address(i2c_addr),
+      _pointer(0),
+      _fault(false),
+      _shunt_voltage(0),
+      _bus_voltage(0),
+      _die_temp(25),
+      _now(0),
+      _reads(0),
+      _writes(0) {
+  reset();
+}
+
+/**************************************************************************/
+/*!
+    @brief Puts every register back to its power-on value
+*/
+/**************************************************************************/
+void INA228_Simulator::reset(void) {
+  for (uint8_t i = 0; i < INA228_SIM_REGISTERS; i++) {
+    _regs[i] = 0;
+  }
+  _regs[SIM_REG_ADCCFG] = 0xFB68;
+  _regs[SIM_REG_SHUNTCAL] = 0x1000;
+  _regs[SIM_REG_DIAGALRT] = 0x0001; // MEMSTAT: memory checksum OK
+  _regs[SIM_REG_SOVL] = 0x7FFF;
+  _regs[SIM_REG_SUVL] = 0x8000;
+  _regs[SIM_REG_BOVL] = 0x7FFF;
+  _regs[SIM_REG_TEMPLIMIT] = 0x7FFF;
+  _regs[SIM_REG_PWRLIMIT] = 0xFFFF;
+  _regs[SIM_REG_MFG_UID] = 0x5449;
+  _regs[SIM_REG_DVC_UID] = 0x2281;
+  _energy = 0;
+  _charge = 0;
+  _conversions = 0;
+  _restartConversion();
+}
+
+/**************************************************************************/
+/*!
+    @brief Handles a write transaction: a register pointer, optionally
+    followed by a 16-bit value MSB first
+    @param buffer
+          The bytes written after the address
+    @param len
+          Number of bytes
+    @return False if the device NACKed
+*/
+/**************************************************************************/
+bool INA228_Simulator::write(const uint8_t* buffer, size_t len) {
+  if (_fault) {
+    return false;
+  }
+  _writes++;
+  if (len == 0) {
+    return true; // address probe
+  }
+  if (!registerWidth(buffer[0])) {
+    return false;
+  }
+  _pointer = buffer[0];
+  if (len >= 3) {
+    _writeRegister(_pointer, (uint16_t)buffer[1] << 8 | buffer[2]);
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Handles a read transaction from the current register pointer
+    @param buffer
+          Receives the register bytes MSB first, bytes past the register
+          width read as zero
+    @param len
+          Number of bytes
+    @return False if the device NACKed
+*/
+/**************************************************************************/
+bool INA228_Simulator::read(uint8_t* buffer, size_t len) {
+  if (_fault) {
+    return false;
+  }
+  _reads++;
+  uint8_t width = registerWidth(_pointer);
+  uint64_t value = _regs[_pointer];
+  for (size_t i = 0; i < len; i++) {
+    buffer[i] = i < width ? (value >> (8 * (width - 1 - i))) & 0xFF : 0;
+  }
+
+  uint64_t& diag = _regs[SIM_REG_DIAGALRT];
+  if (_pointer == SIM_REG_DIAGALRT) {
+    // reading DIAG_ALRT clears conversion ready and latched alerts
+    diag &= ~((1ULL << SIM_CNVRF) | (1ULL << SIM_MATHOF));
+    if (diag & (1ULL << SIM_ALATCH)) {
+      diag &= ~(uint64_t)SIM_LIMIT_FLAGS;
+    }
+  } else if (_pointer == SIM_REG_ENERGY) {
+    diag &= ~(1ULL << SIM_ENERGYOF);
+  } else if (_pointer == SIM_REG_CHARGE) {
+    diag &= ~(1ULL << SIM_CHARGEOF);
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the I2C address of the device
+    @return 7-bit address
+*/
+/**************************************************************************/
+uint8_t INA228_Simulator::address(void) const {
+  return _address;
+}
+
+/**************************************************************************/
+/*!
+    @brief Makes every following transaction fail, to test error handling
+    @param fault
+          True to NACK everything, false to recover
+*/
+/**************************************************************************/
+void INA228_Simulator::setFault(bool fault) {
+  _fault = fault;
+}
+
+/**************************************************************************/
+/*!
+    @brief Sets the voltage across IN+ and IN-
+    @param volts
+          Shunt voltage in V
+*/
+/**************************************************************************/
+void INA228_Simulator::setShuntVoltage(float volts) {
+  _shunt_voltage = volts;
+}
+
+/**************************************************************************/
+/*!
+    @brief Sets the voltage on VBUS
+    @param volts
+          Bus voltage in V
+*/
+/**************************************************************************/
+void INA228_Simulator::setBusVoltage(float volts) {
+  _bus_voltage = volts;
+}
+
+/**************************************************************************/
+/*!
+    @brief Sets the die temperature
+    @param celsius
+          Temperature in deg C
+*/
+/**************************************************************************/
+void INA228_Simulator::setDieTemperature(float celsius) {
+  _die_temp = celsius;
+}
+
+/**************************************************************************/
+/*!
+    @brief Lets time pass, completing any conversions that finish within it
+    @param us
+          Time step in us
+*/
+/**************************************************************************/
+void INA228_Simulator::advance(uint32_t us) {
+  _now += us;
+  while (us) {
+    uint8_t mode = _regs[SIM_REG_ADCCFG] >> 12;
+    uint32_t period = conversionPeriod();
+    if (!period || (mode < 8 && _triggered_done)) {
+      return; // shut down, or the single shot is finished
+    }
+    if (_delay) {
+      uint32_t step = us < _delay ? us : _delay;
+      _delay -= step;
+      us -= step;
+      continue;
+    }
+    uint32_t left = period - _elapsed;
+    if (us < left) {
+      _elapsed += us;
+      return;
+    }
+    us -= left;
+    _elapsed = 0;
+    _convert();
+    if (mode < 8) {
+      _triggered_done = true;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Peeks at a register without the side effects of a bus read
+    @param reg
+          Register address
+    @return Register contents
+*/
+/**************************************************************************/
+uint64_t INA228_Simulator::getRegister(uint8_t reg) const {
+  return reg < INA228_SIM_REGISTERS ? _regs[reg] : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief Overwrites a register directly, for example to preload the
+    accumulators close to wrapping
+    @param reg
+          Register address
+    @param value
+          New contents
+*/
+/**************************************************************************/
+void INA228_Simulator::setRegister(uint8_t reg, uint64_t value) {
+  if (reg >= INA228_SIM_REGISTERS) {
+    return;
+  }
+  _regs[reg] = value;
+  if (reg == SIM_REG_ENERGY) {
+    _energy = (double)value;
+  } else if (reg == SIM_REG_CHARGE) {
+    _charge = (double)(int64_t)value;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the width of a register
+    @param reg
+          Register address
+    @return Width in bytes, 0 for addresses the INA228 does not have
+*/
+/**************************************************************************/
+uint8_t INA228_Simulator::registerWidth(uint8_t reg) {
+  switch (reg) {
+  case SIM_REG_VSHUNT:
+  case SIM_REG_VBUS:
+  case SIM_REG_CURRENT:
+  case SIM_REG_POWER:
+    return 3;
+  case SIM_REG_ENERGY:
+  case SIM_REG_CHARGE:
+    return 5;
+  case SIM_REG_MFG_UID:
+  case SIM_REG_DVC_UID:
+    return 2;
+  default:
+    return reg <= SIM_REG_PWRLIMIT ? 2 : 0;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns whether the ALERT output is active, before polarity
+    @return True if conversion ready (when routed to ALERT) or a limit flag
+    is set
+*/
+/**************************************************************************/
+bool INA228_Simulator::alertAsserted(void) const {
+  uint64_t diag = _regs[SIM_REG_DIAGALRT];
+  if ((diag & (1ULL << SIM_CNVR)) && (diag & (1ULL << SIM_CNVRF))) {
+    return true;
+  }
+  return diag & SIM_LIMIT_FLAGS;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the simulated time
+    @return Total time passed to advance() in us
+*/
+/**************************************************************************/
+uint32_t INA228_Simulator::now(void) const {
+  return _now;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the conversion period for the current ADC_CONFIG
+    @return Period in us, 0 in shutdown
+*/
+/**************************************************************************/
+uint32_t INA228_Simulator::conversionPeriod(void) const {
+  static const uint16_t times[] = {50, 84, 150, 280, 540, 1052, 2074, 4120};
+  static const uint16_t counts[] = {1, 4, 16, 64, 128, 256, 512, 1024};
+  uint16_t adc_config = _regs[SIM_REG_ADCCFG];
+  uint8_t mode = adc_config >> 12;
+
+  uint32_t per_sample = 0;
+  if (mode & 0x1) {
+    per_sample += times[(adc_config >> 9) & 0x7];
+  }
+  if (mode & 0x2) {
+    per_sample += times[(adc_config >> 6) & 0x7];
+  }
+  if (mode & 0x4) {
+    per_sample += times[(adc_config >> 3) & 0x7];
+  }
+  return per_sample * counts[adc_config & 0x7];
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the number of completed conversions
+    @return Conversions since the last reset
+*/
+/**************************************************************************/
+uint32_t INA228_Simulator::conversions(void) const {
+  return _conversions;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the number of read transactions seen
+    @return Read count
+*/
+/**************************************************************************/
+uint32_t INA228_Simulator::reads(void) const {
+  return _reads;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the number of write transactions seen
+    @return Write count
+*/
+/**************************************************************************/
+uint32_t INA228_Simulator::writes(void) const {
+  return _writes;
+}
+
+/**************************************************************************/
+/*!
+    @brief Applies a register write with the side effects of the real chip
+    @param reg
+          Register address
+    @param value
+          Value written
+*/
+/**************************************************************************/
+void INA228_Simulator::_writeRegister(uint8_t reg, uint16_t value) {
+  switch (reg) {
+  case SIM_REG_CONFIG:
+    if (value & 0x8000) {
+      reset();
+      return;
+    }
+    if (value & 0x4000) {
+      _energy = 0;
+      _charge = 0;
+      _regs[SIM_REG_ENERGY] = 0;
+      _regs[SIM_REG_CHARGE] = 0;
+    }
+    _regs[reg] = value & 0x3FF0;
+    break;
+  case SIM_REG_ADCCFG:
+    _regs[reg] = value;
+    _restartConversion();
+    break;
+  case SIM_REG_SHUNTCAL:
+    _regs[reg] = value & 0x7FFF;
+    break;
+  case SIM_REG_SHUNTTEMPCO:
+    _regs[reg] = value & 0x3FFF;
+    break;
+  case SIM_REG_DIAGALRT:
+    // only the control bits are writable, the rest are flags
+    _regs[reg] = (_regs[reg] & 0x0FFF) | (value & 0xF000);
+    break;
+  case SIM_REG_SOVL:
+  case SIM_REG_SUVL:
+  case SIM_REG_BOVL:
+  case SIM_REG_BUVL:
+  case SIM_REG_TEMPLIMIT:
+  case SIM_REG_PWRLIMIT:
+    _regs[reg] = reg == SIM_REG_BOVL || reg == SIM_REG_BUVL ? value & 0x7FFF
+                                                            : value;
+    break;
+  default:
+    break; // result and ID registers are read only
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Starts the conversion cycle over, after the CONFIG conversion
+    delay
+*/
+/**************************************************************************/
+void INA228_Simulator::_restartConversion(void) {
+  _elapsed = 0;
+  _delay = ((_regs[SIM_REG_CONFIG] >> 6) & 0xFF) * 2000UL;
+  _triggered_done = false;
+}
+
+/**************************************************************************/
+/*!
+    @brief Sets or clears a DIAG_ALRT flag
+    @param bit
+          Flag position
+    @param set
+          New state
+*/
+/**************************************************************************/
+void INA228_Simulator::_setFlag(uint8_t bit, bool set) {
+  if (set) {
+    _regs[SIM_REG_DIAGALRT] |= 1ULL << bit;
+  } else {
+    _regs[SIM_REG_DIAGALRT] &= ~(1ULL << bit);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Completes a conversion: updates the result registers, the
+    accumulators and the DIAG_ALRT flags
+*/
+/**************************************************************************/
+void INA228_Simulator::_convert(void) {
+  uint8_t mode = _regs[SIM_REG_ADCCFG] >> 12;
+  bool high_res = _regs[SIM_REG_CONFIG] & 0x0010;
+  double seconds = conversionPeriod() / 1e6;
+
+  if (mode & 0x2) {
+    double lsb = high_res ? 78.125e-9 : 312.5e-9;
+    double counts = floor(_shunt_voltage / lsb + 0.5);
+    if (counts > SIM_FULL_SCALE_20) {
+      counts = SIM_FULL_SCALE_20;
+    } else if (counts < -SIM_FULL_SCALE_20 - 1) {
+      counts = -SIM_FULL_SCALE_20 - 1;
+    }
+    _regs[SIM_REG_VSHUNT] = ((uint64_t)(int32_t)counts & 0xFFFFF) << 4;
+  }
+  if (mode & 0x1) {
+    double counts = floor(_bus_voltage / 195.3125e-6 + 0.5);
+    counts = counts < 0 ? 0 : counts;
+    counts = counts > SIM_FULL_SCALE_20 ? SIM_FULL_SCALE_20 : counts;
+    _regs[SIM_REG_VBUS] = (uint64_t)counts << 4;
+  }
+  if (mode & 0x4) {
+    double counts = floor(_die_temp / 7.8125e-3 + 0.5);
+    _regs[SIM_REG_DIETEMP] = (uint16_t)(int16_t)counts;
+  }
+
+  int32_t vshunt = (int32_t)(_regs[SIM_REG_VSHUNT] >> 4);
+  if (vshunt & 0x80000)
+    vshunt |= 0xFFF00000;
+  uint32_t vbus = _regs[SIM_REG_VBUS] >> 4;
+  int16_t temp = (int16_t)_regs[SIM_REG_DIETEMP];
+
+  // SHUNT_CAL = 13107.2e6 x CURRENT_LSB x RSHUNT (x4 in the low range),
+  // so CURRENT = VSHUNT x 4096 / SHUNT_CAL in both ranges
+  uint16_t shunt_cal = _regs[SIM_REG_SHUNTCAL];
+  int64_t current = shunt_cal ? (int64_t)vshunt * 4096 / shunt_cal : 0;
+  _setFlag(SIM_MATHOF,
+           current > SIM_FULL_SCALE_20 || current < -SIM_FULL_SCALE_20 - 1);
+  if (current > SIM_FULL_SCALE_20) {
+    current = SIM_FULL_SCALE_20;
+  } else if (current < -SIM_FULL_SCALE_20 - 1) {
+    current = -SIM_FULL_SCALE_20 - 1;
+  }
+  _regs[SIM_REG_CURRENT] = ((uint64_t)current & 0xFFFFF) << 4;
+
+  // POWER LSB is 3.2 x CURRENT_LSB and VBUS LSB is 195.3125 uV
+  uint64_t power = (uint64_t)(current < 0 ? -current : current) * vbus / 16384;
+  power = power > 0xFFFFFF ? 0xFFFFFF : power;
+  _regs[SIM_REG_POWER] = power;
+
+  // ENERGY LSB is 16 x POWER LSB x 1 s, CHARGE LSB is CURRENT_LSB x 1 s
+  _energy += power * seconds / 16;
+  if (_energy >= SIM_ACCUMULATOR_RANGE) {
+    _energy -= SIM_ACCUMULATOR_RANGE;
+    _setFlag(SIM_ENERGYOF, true);
+  }
+  _charge += current * seconds;
+  if (_charge >= SIM_ACCUMULATOR_RANGE / 2) {
+    _charge -= SIM_ACCUMULATOR_RANGE;
+    _setFlag(SIM_CHARGEOF, true);
+  } else if (_charge < -SIM_ACCUMULATOR_RANGE / 2) {
+    _charge += SIM_ACCUMULATOR_RANGE;
+    _setFlag(SIM_CHARGEOF, true);
+  }
+  _regs[SIM_REG_ENERGY] = (uint64_t)_energy;
+  _regs[SIM_REG_CHARGE] = (uint64_t)(int64_t)floor(_charge) & 0xFFFFFFFFFFULL;
+
+  // limits compare against the result registers in the limit LSBs
+  bool latched = _regs[SIM_REG_DIAGALRT] & (1ULL << SIM_ALATCH);
+  bool flags[6] = {
+      temp > (int16_t)_regs[SIM_REG_TEMPLIMIT],
+      (vshunt >> 4) > (int16_t)_regs[SIM_REG_SOVL],
+      (vshunt >> 4) < (int16_t)_regs[SIM_REG_SUVL],
+      (int32_t)(vbus >> 4) > (int32_t)_regs[SIM_REG_BOVL],
+      (int32_t)(vbus >> 4) < (int32_t)_regs[SIM_REG_BUVL],
+      (power >> 8) > _regs[SIM_REG_PWRLIMIT],
+  };
+  static const uint8_t bits[6] = {SIM_TMPOL,  SIM_SHNTOL, SIM_SHNTUL,
+                                  SIM_BUSOL,  SIM_BUSUL,  SIM_POL};
+  for (uint8_t i = 0; i < 6; i++) {
+    if (flags[i] || !latched) {
+      _setFlag(bits[i], flags[i]);
+    }
+  }
+
+  _setFlag(SIM_CNVRF, true);
+  _conversions++;
+}
+
+/*!
+ *    @brief  Binds the transport to a simulated device
+ *    @param  simulator
+ *            The simulator to talk to
+ *    @param  clock_hz
+ *            Modelled SCL frequency, used to add up busMicros()
+ */
+INA228_SimulatorTransport::INA228_SimulatorTransport(
+    INA228_Simulator* simulator, uint32_t clock_hz)
+    : _simulator(simulator),
+      _transactions(0),
+      _clock_hz(clock_hz ? clock_hz : INA2XX_I2C_STANDARD),
+      _bus_ns(0) {}
+
+/**************************************************************************/
+/*!
+    @brief Probes the simulated device with an empty write
+    @return True if the device acknowledged
+*/
+/**************************************************************************/
+bool INA228_SimulatorTransport::begin(void) {
+  _transactions++;
+  _addBusTime(2 + 9);
+  return _simulator->write(NULL, 0);
+}
+
+/**************************************************************************/
+/*!
+    @brief Writes bytes to the simulated device
+    @param buffer
+          Bytes to send, the register pointer first
+    @param len
+          Number of bytes
+    @return True if the device acknowledged them
+*/
+/**************************************************************************/
+bool INA228_SimulatorTransport::write(const uint8_t* buffer, size_t len) {
+  _transactions++;
+  _addBusTime(2 + 9 * (1 + len));
+  return _simulator->write(buffer, len);
+}
+
+/**************************************************************************/
+/*!
+    @brief Writes the register pointer, then reads from the simulated device
+    @param write_buffer
+          Bytes to send
+    @param write_len
+          Number of bytes to send
+    @param read_buffer
+          Receives the bytes read
+    @param read_len
+          Number of bytes to read
+    @return True if the transaction succeeded
+*/
+/**************************************************************************/
+bool INA228_SimulatorTransport::writeThenRead(const uint8_t* write_buffer,
+                                              size_t write_len,
+                                              uint8_t* read_buffer,
+                                              size_t read_len) {
+  _transactions++;
+  _addBusTime(3 + 9 * (2 + write_len + read_len));
+  return _simulator->write(write_buffer, write_len) &&
+         _simulator->read(read_buffer, read_len);
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads several registers. The bus time is what readMicros()
+    gives, so in High-speed mode the reads share one master code.
+    @param reads
+          The registers to read
+    @param count
+          Number of entries in reads
+    @return True if every read succeeded
+*/
+/**************************************************************************/
+bool INA228_SimulatorTransport::readRegisters(INA2xx_RegisterRead* reads,
+                                              uint8_t count) {
+  uint32_t bits = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    bits += 3 + 9 * (3 + reads[i].len);
+  }
+  _addBusTime(bits);
+  for (uint8_t i = 0; i < count; i++) {
+    _transactions++;
+    if (!_simulator->write(&reads[i].reg, 1) ||
+        !_simulator->read(reads[i].buffer, reads[i].len)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Changes the modelled SCL frequency. Every speed the INA228
+    supports is taken, High-speed mode included.
+    @param clock_hz
+          The SCL frequency in Hz, up to INA2XX_I2C_HIGH_SPEED
+    @return True if the speed is within range
+*/
+/**************************************************************************/
+bool INA228_SimulatorTransport::setClock(uint32_t clock_hz) {
+  if (!clock_hz || clock_hz > INA2XX_I2C_HIGH_SPEED) {
+    return false;
+  }
+  _clock_hz = clock_hz;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Gets the simulated device
+    @return The simulator passed to the constructor
+*/
+/**************************************************************************/
+INA228_Simulator* INA228_SimulatorTransport::simulator(void) const {
+  return _simulator;
+}
+
+/**************************************************************************/
+/*!
+    @brief Counts the transactions, to check how many bus round trips an
+    operation takes
+    @return Number of transactions since construction
+*/
+/**************************************************************************/
+uint32_t INA228_SimulatorTransport::transactions(void) const {
+  return _transactions;
+}
+
+/**************************************************************************/
+/*!
+    @brief Gets the modelled SCL frequency
+    @return The clock in Hz
+*/
+/**************************************************************************/
+uint32_t INA228_SimulatorTransport::clock(void) const {
+  return _clock_hz;
+}
+
+/**************************************************************************/
+/*!
+    @brief Adds up how long the transactions so far would have kept a real
+    bus busy at the clock each one ran at
+    @return Bus time in us since construction
+*/
+/**************************************************************************/
+uint32_t INA228_SimulatorTransport::busMicros(void) const {
+  return (uint32_t)(_bus_ns / 1000);
+}
+
+/**************************************************************************/
+/*!
+    @brief Charges one transaction to busMicros(). In High-speed mode it
+    starts with the master code at INA2XX_I2C_FAST, since the stop of the
+    last transaction ended HS.
+    @param bits
+          SCL cycles of the transaction, starts and stop included
+*/
+/**************************************************************************/
+void INA228_SimulatorTransport::_addBusTime(uint32_t bits) {
+  _bus_ns += (uint64_t)bits * 1000000000UL / _clock_hz;
+  if (_clock_hz > INA2XX_I2C_FAST_PLUS) {
+    _bus_ns += 10 * 1000000000ULL / INA2XX_I2C_FAST;
+  }
+}
+
+/*!
+ *    @brief  Binds the transport to a simulated device
+ *    @param  simulator
+ *            The simulator to talk to. Its time only moves with advance().
+ *    @param  clock_hz
+ *            Modelled SCL frequency
+ */
+INA228_AsyncSimulatorTransport::INA228_AsyncSimulatorTransport(
+    INA228_Simulator* simulator, uint32_t clock_hz)
+    : INA228_SimulatorTransport(simulator, clock_hz),
+      _active(NULL),
+      _started(0),
+      _duration(0) {}
+
+/**************************************************************************/
+/*!
+    @brief Puts a transfer on the simulated wire and returns at once
+    @param transfer
+          The transfer, with pending set
+    @return True if started, false if another transfer is still running
+*/
+/**************************************************************************/
+bool INA228_AsyncSimulatorTransport::startTransfer(
+    INA2xx_Transfer* transfer) {
+  if (_active) {
+    return false;
+  }
+  _active = transfer;
+  _started = simulator()->now();
+  _duration = transferMicros(transfer);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Checks whether a transfer is on the simulated wire
+    @return True until the running transfer has completed
+*/
+/**************************************************************************/
+bool INA228_AsyncSimulatorTransport::busy(void) {
+  return _active != NULL;
+}
+
+/**************************************************************************/
+/*!
+    @brief Completes the running transfer once its bus time has passed in
+    simulator time. The registers are read at that moment, and done is
+    called from here.
+*/
+/**************************************************************************/
+void INA228_AsyncSimulatorTransport::poll(void) {
+  if (!_active || simulator()->now() - _started < _duration) {
+    return;
+  }
+  INA2xx_Transfer* transfer = _active;
+  _active = NULL;
+  transfer->ok = readRegisters(transfer->reads, transfer->count);
+  transfer->pending = false;
+  transfer->done(transfer);
+}
+
+/**************************************************************************/
+/*!
+    @brief Works out how long a transfer keeps the bus busy, with
+    INA2xx_Transport::readMicros() at the modelled clock
+    @param transfer
+          The transfer
+    @return Bus time in us, rounded up
+*/
+/**************************************************************************/
+uint32_t INA228_AsyncSimulatorTransport::transferMicros(
+    const INA2xx_Transfer* transfer) const {
+  return readMicros(transfer->reads, transfer->count, clock());
+}
@@ -0,0 +1,142 @@
+/*!
+ *  @file Adafruit_INA228_Simulator.h
+ *
+ * 	Register-level model of the INA228, for running the driver without
+ *  hardware
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_SIMULATOR_H
+#define _ADAFRUIT_INA228_SIMULATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Adafruit_INA2xx_Transport.h"
+
+#define INA228_SIM_REGISTERS 0x40 ///< Size of the register address space
+
+/*!
+ *    @brief  Simulated INA228 at the register level. Plain C++ with no
+ *            Arduino dependencies, so it builds for boards and hosts alike.
+ *
+ *    The model covers the ID registers, CONFIG (reset, accumulator reset,
+ *    ADC range, conversion delay), ADC_CONFIG (mode, conversion times,
+ *    averaging), the 20-bit and 40-bit result registers, the limit
+ *    registers and the DIAG_ALRT flags. Time only moves when advance() is
+ *    called, and conversions complete when their modelled time is up.
+ */
+class INA228_Simulator {
+ public:
+  INA228_Simulator(uint8_t i2c_addr = 0x40);
+  void reset(void);
+
+  // I2C side, as seen by a controller
+  bool write(const uint8_t* buffer, size_t len);
+  bool read(uint8_t* buffer, size_t len);
+  uint8_t address(void) const;
+  void setFault(bool fault);
+
+  // Analog side
+  void setShuntVoltage(float volts);
+  void setBusVoltage(float volts);
+  void setDieTemperature(float celsius);
+  void advance(uint32_t us);
+
+  uint64_t getRegister(uint8_t reg) const;
+  void setRegister(uint8_t reg, uint64_t value);
+  static uint8_t registerWidth(uint8_t reg);
+  bool alertAsserted(void) const;
+  uint32_t now(void) const;
+  uint32_t conversionPeriod(void) const;
+  uint32_t conversions(void) const;
+  uint32_t reads(void) const;
+  uint32_t writes(void) const;
+
+ private:
+  void _writeRegister(uint8_t reg, uint16_t value);
+  void _convert(void);
+  void _restartConversion(void);
+  void _setFlag(uint8_t bit, bool set);
+
+  uint8_t _address;                      ///< 7-bit I2C address
+  uint8_t _pointer;                      ///< Register pointer
+  bool _fault;                           ///< NACK every transaction
+  uint64_t _regs[INA228_SIM_REGISTERS];  ///< Register contents
+  float _shunt_voltage;                  ///< Shunt voltage input in V
+  float _bus_voltage;                    ///< Bus voltage input in V
+  float _die_temp;                       ///< Die temperature input in C
+  double _energy;                        ///< Exact ENERGY count
+  double _charge;                        ///< Exact CHARGE count
+  uint32_t _now;                         ///< Simulated time in us
+  uint32_t _elapsed;                     ///< Time into the current conversion
+  uint32_t _delay;                       ///< Remaining CONVDLY time in us
+  bool _triggered_done;                  ///< Single shot finished
+  uint32_t _conversions;                 ///< Completed conversions
+  uint32_t _reads;                       ///< Read transactions
+  uint32_t _writes;                      ///< Write transactions
+};
+
+/*!
+ *    @brief  Transport that talks to an INA228_Simulator, so the driver can
+ *            be run and tested on a host with no bus at all
+ */
+class INA228_SimulatorTransport : public INA2xx_Transport {
+ public:
+  INA228_SimulatorTransport(INA228_Simulator* simulator,
+                            uint32_t clock_hz = INA2XX_I2C_STANDARD);
+
+  bool begin(void) override;
+  bool write(const uint8_t* buffer, size_t len) override;
+  bool writeThenRead(const uint8_t* write_buffer, size_t write_len,
+                     uint8_t* read_buffer, size_t read_len) override;
+  bool readRegisters(INA2xx_RegisterRead* reads, uint8_t count) override;
+  bool setClock(uint32_t clock_hz) override;
+
+  INA228_Simulator* simulator(void) const;
+  uint32_t transactions(void) const;
+  uint32_t clock(void) const;
+  uint32_t busMicros(void) const;
+
+ private:
+  void _addBusTime(uint32_t bits);
+
+  INA228_Simulator* _simulator; ///< The device on the other end
+  uint32_t _transactions;       ///< Transactions done through this transport
+  uint32_t _clock_hz;           ///< Modelled SCL frequency
+  uint64_t _bus_ns;             ///< Modelled bus time of all transactions
+};
+
+/*!
+ *    @brief  Simulator transport that runs transfers in the background, like
+ *            an interrupt or DMA driven I2C peripheral. A started transfer
+ *            takes the time its bytes need at the bus clock, in simulator
+ *            time, and completes from poll() once that has passed.
+ */
+class INA228_AsyncSimulatorTransport : public INA228_SimulatorTransport {
+ public:
+  INA228_AsyncSimulatorTransport(INA228_Simulator* simulator,
+                                 uint32_t clock_hz = INA2XX_I2C_STANDARD);
+
+  bool startTransfer(INA2xx_Transfer* transfer) override;
+  bool busy(void) override;
+  void poll(void) override;
+
+  uint32_t transferMicros(const INA2xx_Transfer* transfer) const;
+
+ private:
+  INA2xx_Transfer* _active; ///< Transfer on the wire, NULL if idle
+  uint32_t _started;        ///< Simulator time the transfer started
+  uint32_t _duration;       ///< Bus time of the active transfer in us
+};
+
+#endif
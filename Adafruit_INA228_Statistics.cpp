@@ -0,0 +1,243 @@
+/*!
+ *  @file Adafruit_INA228_Statistics.cpp
+ *
+ * 	Running per-channel statistics over a stream of INA228 readings
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_INA228_Statistics.h"
+
+#include <math.h>
+
+/*!
+ *    @brief  Instantiates empty statistics
+ *    @param  channels
+ *            INA228_Channel bits to keep statistics for. ENERGY and CHARGE
+ *            are running totals already and are ignored.
+ */
+INA228_Statistics::INA228_Statistics(uint8_t channels)
+    : _mask(channels & ((1 << INA228_STATS_CHANNELS) - 1)) {
+  reset();
+}
+
+/**************************************************************************/
+/*!
+    @brief Adds the tracked channels a snapshot holds
+    @param snapshot
+          A reading, only the channels in its mask are used
+*/
+/**************************************************************************/
+void INA228_Statistics::add(const INA228_Snapshot& snapshot) {
+  uint8_t valid = snapshot.mask & _mask;
+  if (!valid) {
+    return;
+  }
+  _stamp(snapshot.timestamp_us);
+  const float values[INA228_STATS_CHANNELS] = {
+      snapshot.shunt_voltage_mV, snapshot.bus_voltage_V, snapshot.die_temp_C,
+      snapshot.current_mA, snapshot.power_mW};
+  for (uint8_t i = 0; i < INA228_STATS_CHANNELS; i++) {
+    if (valid & (1 << i)) {
+      _add(i, values[i]);
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Adds the tracked channels of a triggered conversion
+    @param measurement
+          The result of Adafruit_INA2xx::poll(), all channels valid
+*/
+/**************************************************************************/
+void INA228_Statistics::add(const INA2XX_Measurement& measurement) {
+  INA228_Snapshot snapshot;
+  snapshot.mask = INA228_CHANNEL_SHUNT_VOLTAGE | INA228_CHANNEL_BUS_VOLTAGE |
+                  INA228_CHANNEL_DIE_TEMP | INA228_CHANNEL_CURRENT |
+                  INA228_CHANNEL_POWER;
+  snapshot.timestamp_us = measurement.timestamp_us;
+  snapshot.shunt_voltage_mV = measurement.shunt_voltage_mV;
+  snapshot.bus_voltage_V = measurement.bus_voltage_V;
+  snapshot.die_temp_C = measurement.die_temp_C;
+  snapshot.current_mA = measurement.current_mA;
+  snapshot.power_mW = measurement.power_mW;
+  add(snapshot);
+}
+
+/**************************************************************************/
+/*!
+    @brief Adds one value, such as the result of getCurrent_mA(). Single
+    values carry no timestamp.
+    @param channel
+          The channel the value belongs to, a single INA228_Channel bit
+    @param value
+          The reading, in the units of INA228_Snapshot
+*/
+/**************************************************************************/
+void INA228_Statistics::add(INA228_Channel channel, float value) {
+  int8_t index = _index(channel);
+  if (index >= 0) {
+    _add(index, value);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Forgets all samples
+*/
+/**************************************************************************/
+void INA228_Statistics::reset(void) {
+  for (uint8_t i = 0; i < INA228_STATS_CHANNELS; i++) {
+    _channels[i].count = 0;
+    _channels[i].mean = 0;
+    _channels[i].m2 = 0;
+    _channels[i].min = 0;
+    _channels[i].max = 0;
+  }
+  _stamped = false;
+  _first_us = 0;
+  _last_us = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief Ends an interval: copies the running state and starts over. Only
+    a copy of a few bytes, the statistics are worked out when the copy is
+    read.
+    @param interval
+          Receives the statistics of the interval that just ended
+*/
+/**************************************************************************/
+void INA228_Statistics::snapshotAndReset(INA228_Statistics& interval) {
+  interval = *this;
+  reset();
+}
+
+/**************************************************************************/
+/*!
+    @brief Works out the statistics of one channel
+    @param channel
+          A single INA228_Channel bit
+    @param stats
+          Set to the statistics, all zero without samples
+    @return True if the channel is tracked and has samples
+*/
+/**************************************************************************/
+bool INA228_Statistics::read(INA228_Channel channel,
+                             INA228_ChannelStats& stats) const {
+  int8_t index = _index(channel);
+  const Accumulator* acc = index >= 0 ? &_channels[index] : NULL;
+  if (!acc || !acc->count) {
+    stats.count = 0;
+    stats.min = stats.max = stats.mean = stats.rms = stats.variance = 0;
+    return false;
+  }
+  stats.count = acc->count;
+  stats.min = acc->min;
+  stats.max = acc->max;
+  stats.mean = acc->mean;
+  stats.variance = acc->m2 / acc->count;
+  // the mean square is the squared mean plus the variance
+  stats.rms = sqrtf(acc->mean * acc->mean + stats.variance);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns how many samples a channel has
+    @param channel
+          A single INA228_Channel bit
+    @return Sample count since the last reset, 0 if not tracked
+*/
+/**************************************************************************/
+uint32_t INA228_Statistics::count(INA228_Channel channel) const {
+  int8_t index = _index(channel);
+  return index >= 0 ? _channels[index].count : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the timestamp of the first snapshot or measurement added
+    since the last reset
+    @return micros() of the sample, 0 if there was none
+*/
+/**************************************************************************/
+uint32_t INA228_Statistics::firstTimestamp(void) const {
+  return _first_us;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the timestamp of the latest snapshot or measurement
+    @return micros() of the sample, 0 if there was none
+*/
+/**************************************************************************/
+uint32_t INA228_Statistics::lastTimestamp(void) const {
+  return _last_us;
+}
+
+/**************************************************************************/
+/*!
+    @brief Welford's update of one channel. Keeps the mean and the sum of
+    squared distances from it, which stays accurate in float where a sum of
+    squares would cancel out.
+    @param index
+          Channel index, the bit position of its INA228_Channel
+    @param value
+          The sample
+*/
+/**************************************************************************/
+void INA228_Statistics::_add(uint8_t index, float value) {
+  Accumulator& acc = _channels[index];
+  if (!acc.count++) {
+    acc.min = acc.max = value;
+  } else if (value < acc.min) {
+    acc.min = value;
+  } else if (value > acc.max) {
+    acc.max = value;
+  }
+  float delta = value - acc.mean;
+  acc.mean += delta / acc.count;
+  acc.m2 += delta * (value - acc.mean);
+}
+
+/**************************************************************************/
+/*!
+    @brief Records the timestamp of a sample
+    @param timestamp_us
+          micros() of the sample
+*/
+/**************************************************************************/
+void INA228_Statistics::_stamp(uint32_t timestamp_us) {
+  if (!_stamped) {
+    _first_us = timestamp_us;
+    _stamped = true;
+  }
+  _last_us = timestamp_us;
+}
+
+/**************************************************************************/
+/*!
+    @brief Maps a channel bit to its index
+    @param channel
+          A single INA228_Channel bit
+    @return Index into the channel state, or -1 if not tracked
+*/
+/**************************************************************************/
+int8_t INA228_Statistics::_index(INA228_Channel channel) const {
+  for (int8_t i = 0; i < INA228_STATS_CHANNELS; i++) {
+    if (channel == (1 << i) && (_mask & channel)) {
+      return i;
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,86 @@
+/*!
+ *  @file Adafruit_INA228_Statistics.h
+ *
+ * 	Running per-channel statistics over a stream of INA228 readings
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA228_STATISTICS_H
+#define _ADAFRUIT_INA228_STATISTICS_H
+
+#include "Adafruit_INA228.h"
+
+/// Channels with statistics: VSHUNT, VBUS, DIETEMP, CURRENT and POWER
+#define INA228_STATS_CHANNELS 5
+
+/**
+ * @brief Summary of one channel over an interval, in the units of
+ * INA228_Snapshot: mV, V, deg C, mA and mW.
+ */
+typedef struct {
+  uint32_t count; ///< Samples added
+  float min;      ///< Smallest sample, 0 without samples
+  float max;      ///< Largest sample, 0 without samples
+  float mean;     ///< Average
+  float rms;      ///< Root mean square
+  float variance; ///< Population variance, the square of the std deviation
+} INA228_ChannelStats;
+
+/*!
+ *    @brief  Keeps count, min, max, mean and variance of each channel with
+ *            Welford's update, so an interval of any length costs the same
+ *            few bytes and no sample has to be stored.
+ *
+ *    Feed it snapshots, poll() measurements or single values, or attach it
+ *    to an INA228_Acquisition. At the end of an interval,
+ *    snapshotAndReset() copies the running state out and starts over; the
+ *    copy is read at leisure while sampling goes on.
+ */
+class INA228_Statistics {
+ public:
+  INA228_Statistics(uint8_t channels = INA228_CHANNEL_ALL);
+
+  void add(const INA228_Snapshot& snapshot);
+  void add(const INA2XX_Measurement& measurement);
+  void add(INA228_Channel channel, float value);
+  void reset(void);
+  void snapshotAndReset(INA228_Statistics& interval);
+
+  bool read(INA228_Channel channel, INA228_ChannelStats& stats) const;
+  uint32_t count(INA228_Channel channel) const;
+  uint32_t firstTimestamp(void) const;
+  uint32_t lastTimestamp(void) const;
+
+ private:
+  /**
+   * @brief Running state of one channel.
+   */
+  typedef struct {
+    uint32_t count; ///< Samples added
+    float mean;     ///< Running mean
+    float m2;       ///< Sum of squared distances from the mean
+    float min;      ///< Smallest sample
+    float max;      ///< Largest sample
+  } Accumulator;
+
+  void _add(uint8_t index, float value);
+  void _stamp(uint32_t timestamp_us);
+  int8_t _index(INA228_Channel channel) const;
+
+  Accumulator _channels[INA228_STATS_CHANNELS]; ///< By INA228_Channel bit
+  uint8_t _mask;      ///< INA228_Channel bits tracked
+  bool _stamped;      ///< True once a timestamped sample was added
+  uint32_t _first_us; ///< Timestamp of the first sample in the interval
+  uint32_t _last_us;  ///< Timestamp of the latest sample
+};
+
+#endif
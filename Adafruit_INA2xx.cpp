@@ -31,17 +31,44 @@
 
 #include "Adafruit_INA2xx.h"
 
-#include <Wire.h>
-
-#include "Arduino.h"
+#include <new>
+#include <string.h>
 
 /*!
  *    @brief  Instantiates a new INA2xx class
  */
-Adafruit_INA2xx::Adafruit_INA2xx(void) {}
+Adafruit_INA2xx::Adafruit_INA2xx(void)
+    : _transport(NULL),
+      _owns_transport(false),
+      _scheduler(NULL),
+      _bus_clock(0),
+      _cache_enabled(false),
+      _config_cache(INA2XX_CONFIG_DEFAULT),
+      _adc_config_cache(INA2XX_ADCCFG_DEFAULT),
+      _shunt_cal_cache(INA2XX_SHUNTCAL_DEFAULT),
+      _diag_alert_cache(INA2XX_DIAGALRT_DEFAULT &
+                        INA2XX_DIAGALRT_CACHE_MASK),
+      _diag_pending(0),
+      _conversion_state(INA2XX_CONVERSION_IDLE),
+      _conversion_start(0),
+      _conversion_time(0),
+      _conversion_poll_at(0),
+      _conversion_period(0),
+      _conversion_anchor(0),
+      _startup_state(INA2XX_CONVERSION_IDLE),
+      _alert_pin(-1) {
+#ifdef INA2XX_ENABLE_STATS
+  _stats_op = INA2XX_OP_COUNT;
+  resetStats();
+#endif
+}
 
+#if defined(ARDUINO)
 /*!
- *    @brief  Sets up the HW
+ *    @brief  Sets up the HW and waits until the first conversion is done,
+ *            so readings are valid as soon as it returns. Can be called
+ *            again, for example to recover from a bus fault, without using
+ *            any more memory.
  *    @param  i2c_address
  *            The I2C address to be used.
  *    @param  theWire
@@ -49,46 +76,288 @@ Adafruit_INA2xx::Adafruit_INA2xx(void) {}
  *    @param  skipReset
  *            When set to true, will omit resetting all registers to
  *            their default values. Default: false.
+ *    @param  i2c_clock
+ *            SCL frequency in Hz to set the bus to, see setBusClock().
+ *            Default: 0, which leaves the bus at its current speed.
  *    @return True if initialization was successful (including verifying
  *            the manufacturer ID is Texas Instruments: 0x5449), otherwise
  * false.
  */
 bool Adafruit_INA2xx::begin(uint8_t i2c_address, TwoWire* theWire,
-                            bool skipReset) {
-  i2c_dev = new Adafruit_I2CDevice(i2c_address, theWire);
+                            bool skipReset, uint32_t i2c_clock) {
+  if (!beginAsync(i2c_address, theWire, skipReset, i2c_clock)) {
+    return false;
+  }
+  return _waitForStartup();
+}
+#endif
 
-  if (!i2c_dev->begin()) {
+/*!
+ *    @brief  Sets up the HW through the given transport and waits until
+ *            the first conversion is done
+ *    @param  transport
+ *            The bus interface bound to the device, for example an
+ *            INA2xx_LinuxTransport. It has to stay valid while the driver
+ *            is used.
+ *    @param  skipReset
+ *            When set to true, will omit resetting all registers to
+ *            their default values. Default: false.
+ *    @return True if initialization was successful, otherwise false.
+ */
+bool Adafruit_INA2xx::begin(INA2xx_Transport* transport, bool skipReset) {
+  if (!beginAsync(transport, skipReset)) {
     return false;
   }
+  return _waitForStartup();
+}
+
+#if defined(ARDUINO)
+/*!
+ *    @brief  Sets up the HW without waiting for the first conversion. Use
+ *            startupState() or isReady() to find out when readings are
+ *            valid, so several sensors can be brought up at once.
+ *    @param  i2c_address
+ *            The I2C address to be used.
+ *    @param  theWire
+ *            The Wire object to be used for I2C connections.
+ *    @param  skipReset
+ *            When set to true, will omit resetting all registers to
+ *            their default values. The chip keeps converting, so it is
+ *            ready right away. Default: false.
+ *    @param  i2c_clock
+ *            SCL frequency in Hz to set the bus to, see setBusClock().
+ *            Default: 0, which leaves the bus at its current speed.
+ *    @return True if the chip was found, otherwise false.
+ */
+bool Adafruit_INA2xx::beginAsync(uint8_t i2c_address, TwoWire* theWire,
+                                 bool skipReset, uint32_t i2c_clock) {
+  if (i2c_clock) {
+    _bus_clock = i2c_clock;
+  }
+  _releaseTransport();
+  _transport =
+      new (_wire_storage) INA2xx_ArduinoTransport(i2c_address, theWire);
+  _owns_transport = true;
+  return beginAsync(_transport, skipReset);
+}
+#endif
+
+/*!
+ *    @brief  Sets up the HW through the given transport without waiting for
+ *            the first conversion. Chip classes override this to check the
+ *            device ID.
+ *    @param  transport
+ *            The bus interface bound to the device. It has to stay valid
+ *            while the driver is used.
+ *    @param  skipReset
+ *            When set to true, will omit resetting all registers to
+ *            their default values. Default: false.
+ *    @return True if the chip was found, otherwise false.
+ */
+bool Adafruit_INA2xx::beginAsync(INA2xx_Transport* transport,
+                                 bool skipReset) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+  _startup_state = INA2XX_CONVERSION_IDLE;
+  if (transport != _transport) {
+    _releaseTransport();
+  }
+  _transport = transport;
 
-  Adafruit_I2CRegister* device_register =
-      new Adafruit_I2CRegister(i2c_dev, INA2XX_REG_DVC_UID, 2, MSBFIRST);
-  Adafruit_I2CRegister* mfg_register =
-      new Adafruit_I2CRegister(i2c_dev, INA2XX_REG_MFG_UID, 2, MSBFIRST);
-  Adafruit_I2CRegisterBits* device_id =
-      new Adafruit_I2CRegisterBits(device_register, 12, 4);
+  if (!_transport->begin()) {
+    return false;
+  }
+  // Wire.begin() can put the bus back at its default speed. A transport
+  // that can't change the clock, like INA2xx_LinuxTransport, just keeps
+  // its own, so forget the speed and plan with the default.
+  if (_bus_clock && !_transport->setClock(_bus_clock)) {
+    _bus_clock = 0;
+  }
 
   // Check manufacturer ID (should be 0x5449 for Texas Instruments)
-  uint16_t mfg_id = mfg_register->read();
-  if (mfg_id != 0x5449) {
+  uint8_t buff[2];
+  if (!_readRegister(INA2XX_REG_MFG_UID, buff, 2) || buff[0] != 0x54 ||
+      buff[1] != 0x49) {
     return false;
   }
 
   // Store device ID for validation in derived classes
-  _device_id = device_id->read();
-
-  Config = new Adafruit_I2CRegister(i2c_dev, INA2XX_REG_CONFIG, 2, MSBFIRST);
-  ADC_Config =
-      new Adafruit_I2CRegister(i2c_dev, INA2XX_REG_ADCCFG, 2, MSBFIRST);
-  Diag_Alert =
-      new Adafruit_I2CRegister(i2c_dev, INA2XX_REG_DIAGALRT, 2, MSBFIRST);
+  if (!_readRegister(INA2XX_REG_DVC_UID, buff, 2)) {
+    return false;
+  }
+  _device_id = ((uint16_t)buff[0] << 8 | buff[1]) >> 4;
 
   if (!skipReset) {
     reset();
-    delay(2); // delay 2ms to give time for first measurement to finish
+    _armStartup(INA2XX_CONFIG_DEFAULT, INA2XX_ADCCFG_DEFAULT);
+  } else {
+    _startup_state = INA2XX_CONVERSION_READY;
+    if (_cache_enabled) {
+      // the chip kept its old state, so the cache has to be refreshed
+      return resync();
+    }
   }
   return true;
 }
+
+/*!
+ *    @brief  Gets the transport the driver talks through
+ *    @return The transport, NULL before begin()
+ */
+INA2xx_Transport* Adafruit_INA2xx::transport(void) {
+  return _transport;
+}
+
+/*!
+ *    @brief  Sets the I2C clock. Can be called before begin(), which sets
+ *            it again every time; if the transport refuses it then, begin()
+ *            goes on at the transport's own speed and busClock() returns
+ *            INA2XX_I2C_STANDARD. On a shared bus all devices see the new
+ *            speed, so pick one they all support: the INA228 runs up to
+ *            INA2XX_I2C_HIGH_SPEED.
+ *    @param  clock_hz
+ *            SCL frequency in Hz, such as INA2XX_I2C_FAST_PLUS. Above that
+ *            the transport has to support High-speed mode, which only
+ *            INA228_SimulatorTransport does: the Arduino and Linux
+ *            transports reject it.
+ *    @return True if the transport took the speed, or there is no
+ *            transport yet
+ */
+bool Adafruit_INA2xx::setBusClock(uint32_t clock_hz) {
+  if (!clock_hz || (_transport && !_transport->setClock(clock_hz))) {
+    return false;
+  }
+  _bus_clock = clock_hz;
+  return true;
+}
+
+/*!
+ *    @brief  Gets the I2C clock the driver plans its bus time with
+ *    @return SCL frequency in Hz set with setBusClock() or begin(), or
+ *            INA2XX_I2C_STANDARD if it was never set
+ */
+uint32_t Adafruit_INA2xx::busClock(void) {
+  return _bus_clock ? _bus_clock : INA2XX_I2C_STANDARD;
+}
+
+/*!
+ *    @brief  Routes asynchronous reads through a scheduler, so requests
+ *            from several sensors are queued and pipelined. Without one
+ *            they go straight to the transport, which then has to be
+ *            polled with transport()->poll().
+ *    @param  scheduler
+ *            The scheduler, NULL to start transfers directly
+ */
+void Adafruit_INA2xx::setScheduler(INA2xx_Scheduler* scheduler) {
+  _scheduler = scheduler;
+}
+
+/*!
+ *    @brief  Destroys the Wire transport if the driver built it, so
+ *            begin() can build a new one in the same storage
+ */
+void Adafruit_INA2xx::_releaseTransport(void) {
+  if (_owns_transport) {
+    _transport->~INA2xx_Transport();
+    _owns_transport = false;
+  }
+  _transport = NULL;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reports whether the first conversion after beginAsync() is
+    done. Never blocks: until the time the conversion takes has passed it
+    only looks at the ALERT pin, if one was given with setAlertPin(), and
+    after that it polls DIAG_ALRT with a backoff.
+    @return INA2XX_CONVERSION_PENDING while waiting,
+    INA2XX_CONVERSION_READY once readings are valid, or
+    INA2XX_CONVERSION_TIMEOUT if the chip never finished a conversion
+*/
+/**************************************************************************/
+INA2XX_ConversionState Adafruit_INA2xx::startupState(void) {
+  if (_startup_state != INA2XX_CONVERSION_PENDING) {
+    return _startup_state;
+  }
+  // reset() routes conversion ready to the ALERT pin, active low
+  if (_alert_pin >= 0 && digitalRead(_alert_pin) == LOW) {
+    conversionReady(); // clears the flag and marks the conversion
+    _startup_state = INA2XX_CONVERSION_READY;
+    return _startup_state;
+  }
+  uint32_t elapsed = micros() - _startup_start;
+  if (elapsed < _startup_poll_at) {
+    return _startup_state;
+  }
+  if (conversionReady()) {
+    _startup_state = INA2XX_CONVERSION_READY;
+  } else if (elapsed > 2 * _startup_time + 10000) {
+    _startup_state = INA2XX_CONVERSION_TIMEOUT;
+  } else {
+    _startup_poll_at = elapsed + _startup_time / 16 + 50;
+  }
+  return _startup_state;
+}
+
+/**************************************************************************/
+/*!
+    @brief Checks whether readings are valid after beginAsync()
+    @return True once the first conversion is done
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::isReady(void) {
+  return startupState() == INA2XX_CONVERSION_READY;
+}
+
+/**************************************************************************/
+/*!
+    @brief Sets the pin the ALERT output is wired to, so startup can see
+    the first conversion without polling the bus
+    @param pin
+          The pin number, or -1 for none
+*/
+/**************************************************************************/
+void Adafruit_INA2xx::setAlertPin(int8_t pin) {
+  _alert_pin = pin;
+  if (pin >= 0) {
+    // ALERT is open drain
+    pinMode(pin, INPUT_PULLUP);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Starts waiting for the first conversion of a configuration:
+    the conversion delay plus one conversion period
+    @param config
+          CONFIG register value
+    @param adc_config
+          ADC_CONFIG register value
+*/
+/**************************************************************************/
+void Adafruit_INA2xx::_armStartup(uint16_t config, uint16_t adc_config) {
+  _startup_start = micros();
+  // CONVDLY is in 2 ms steps
+  _startup_time =
+      ((config >> 6) & 0xFF) * 2000UL + _conversionMicros(adc_config);
+  _startup_poll_at = _startup_time;
+  // in shutdown no conversion will ever come
+  _startup_state = (adc_config >> 12) & 0x7 ? INA2XX_CONVERSION_PENDING
+                                            : INA2XX_CONVERSION_READY;
+}
+
+/**************************************************************************/
+/*!
+    @brief Blocks until startupState() is no longer pending
+    @return True if the first conversion completed
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::_waitForStartup(void) {
+  while (startupState() == INA2XX_CONVERSION_PENDING) {
+    delayMicroseconds(50);
+  }
+  return _startup_state == INA2XX_CONVERSION_READY;
+}
+
 /**************************************************************************/
 /*!
     @brief Resets the hardware. All registers are set to default values,
@@ -96,11 +365,16 @@ bool Adafruit_INA2xx::begin(uint8_t i2c_address, TwoWire* theWire,
 */
 /**************************************************************************/
 void Adafruit_INA2xx::reset(void) {
-  Adafruit_I2CRegisterBits reset = Adafruit_I2CRegisterBits(Config, 1, 15);
-  reset.write(1);
-  Adafruit_I2CRegisterBits alert_conv =
-      Adafruit_I2CRegisterBits(Diag_Alert, 1, 14);
-  alert_conv.write(1);
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+  _writeRegisterBits(INA2XX_REG_CONFIG, 1, 15, 1);
+  // every register is back at its power-on value, no need to read them back
+  _config_cache = INA2XX_CONFIG_DEFAULT;
+  _adc_config_cache = INA2XX_ADCCFG_DEFAULT;
+  _shunt_cal_cache = INA2XX_SHUNTCAL_DEFAULT;
+  _diag_alert_cache = INA2XX_DIAGALRT_DEFAULT & INA2XX_DIAGALRT_CACHE_MASK;
+  _diag_pending = 0;
+  _adcConfigChanged();
+  _writeRegisterBits(INA2XX_REG_DIAGALRT, 1, 14, 1);
   setMode(INA2XX_MODE_CONTINUOUS);
 }
 
@@ -108,10 +382,12 @@ void Adafruit_INA2xx::reset(void) {
 /*!
     @brief Updates the shunt calibration value to the register.
     This is implemented in the derived classes due to different calculations
+    @return True if the register was written and the value fits
 */
 /**************************************************************************/
-void Adafruit_INA2xx::_updateShuntCalRegister() {
+bool Adafruit_INA2xx::_updateShuntCalRegister() {
   // Implemented in derived classes
+  return true;
 }
 
 /**************************************************************************/
@@ -121,13 +397,16 @@ void Adafruit_INA2xx::_updateShuntCalRegister() {
           Derived classes override this method for their specific settings.
     @param shunt_res Resistance of the shunt in ohms (floating point)
     @param max_current Maximum expected current in A (floating point)
+    @return True if SHUNT_CAL was written and fits its field
 */
 /**************************************************************************/
-void Adafruit_INA2xx::setShunt(float shunt_res, float max_current) {
+bool Adafruit_INA2xx::setShunt(float shunt_res, float max_current) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
   _shunt_res = shunt_res;
   // Default to INA228 behavior (2^19 divisor)
   _current_lsb = max_current / (float)(1UL << 19);
-  _updateShuntCalRegister();
+  _updateScales();
+  return _updateShuntCalRegister();
 }
 
 /**************************************************************************/
@@ -138,9 +417,7 @@ void Adafruit_INA2xx::setShunt(float shunt_res, float max_current) {
 */
 /**************************************************************************/
 void Adafruit_INA2xx::setADCRange(uint8_t adc_range) {
-  Adafruit_I2CRegisterBits adc_range_bit =
-      Adafruit_I2CRegisterBits(Config, 1, 4);
-  adc_range_bit.write(adc_range);
+  _writeRegisterBits(INA2XX_REG_CONFIG, 1, 4, adc_range);
   _updateShuntCalRegister();
 }
 
@@ -151,7 +428,28 @@ void Adafruit_INA2xx::setADCRange(uint8_t adc_range) {
 */
 /**************************************************************************/
 uint8_t Adafruit_INA2xx::getADCRange() {
-  return (Config->read() >> 4) & 1;
+  return _readRegisterBits(INA2XX_REG_CONFIG, 1, 4);
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the shunt resistance given to setShunt()
+    @return Shunt resistance in ohms
+*/
+/**************************************************************************/
+float Adafruit_INA2xx::getShuntResistance(void) {
+  return _shunt_res;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the current LSB that scales CURRENT, POWER, ENERGY and
+    CHARGE, as set up by setShunt()
+    @return Current per CURRENT LSB in A
+*/
+/**************************************************************************/
+float Adafruit_INA2xx::getCurrentLSB(void) {
+  return _current_lsb;
 }
 
 /**************************************************************************/
@@ -163,11 +461,9 @@ uint8_t Adafruit_INA2xx::getADCRange() {
 */
 /**************************************************************************/
 float Adafruit_INA2xx::readDieTemp(void) {
-  Adafruit_I2CRegister temp =
-      Adafruit_I2CRegister(i2c_dev, INA2XX_REG_DIETEMP, 2, MSBFIRST);
-  int16_t t = temp.read();
+  INA2XX_STATS_SCOPE(INA2XX_OP_DIE_TEMP);
   // INA228 uses 16 bits for temperature with 7.8125 m°C/LSB
-  return (float)t * 7.8125 / 1000.0;
+  return (float)readDieTempRaw() * 7.8125 / 1000.0;
 }
 
 /**************************************************************************/
@@ -177,12 +473,8 @@ float Adafruit_INA2xx::readDieTemp(void) {
 */
 /**************************************************************************/
 float Adafruit_INA2xx::readCurrent(void) {
-  Adafruit_I2CRegister current =
-      Adafruit_I2CRegister(i2c_dev, INA2XX_REG_CURRENT, 3, MSBFIRST);
-  int32_t i = current.read();
-  if (i & 0x800000)
-    i |= 0xFF000000;
-  return (float)i / 16.0 * _current_lsb * 1000.0;
+  INA2XX_STATS_SCOPE(INA2XX_OP_CURRENT);
+  return (float)readCurrentRaw() * _current_lsb * 1000.0;
 }
 
 /**************************************************************************/
@@ -205,11 +497,10 @@ float Adafruit_INA2xx::getCurrent_mA(void) {
 */
 /**************************************************************************/
 float Adafruit_INA2xx::readBusVoltage(void) {
-  Adafruit_I2CRegister bus_voltage =
-      Adafruit_I2CRegister(i2c_dev, INA2XX_REG_VBUS, 3, MSBFIRST);
+  INA2XX_STATS_SCOPE(INA2XX_OP_BUS_VOLTAGE);
   // INA228 uses 195.3125 µV/LSB (microvolts) for bus voltage,
   // so we need to divide by 1e6 to get Volts
-  return (float)((uint32_t)bus_voltage.read() >> 4) * 195.3125 / 1e6;
+  return (float)readBusVoltageRaw() * 195.3125 / 1e6;
 }
 
 /**************************************************************************/
@@ -225,21 +516,19 @@ float Adafruit_INA2xx::getBusVoltage_V(void) {
 /**************************************************************************/
 /*!
     @brief Reads and scales the current value of the Shunt Voltage register.
+    @note This base implementation uses the INA228 shunt LSBs.
+          Adafruit_INA2xx_Chip overrides it with the LSBs of its traits.
     @return The current shunt voltage measurement in mV
 */
 /**************************************************************************/
 float Adafruit_INA2xx::readShuntVoltage(void) {
+  // the CONFIG read for the range is part of the shunt voltage read
+  INA2XX_STATS_SCOPE(INA2XX_OP_SHUNT_VOLTAGE);
   float scale = 312.5;
   if (getADCRange()) {
     scale = 78.125;
   }
-
-  Adafruit_I2CRegister shunt_voltage =
-      Adafruit_I2CRegister(i2c_dev, INA2XX_REG_VSHUNT, 3, MSBFIRST);
-  int32_t v = shunt_voltage.read();
-  if (v & 0x800000)
-    v |= 0xFF000000;
-  return (float)v / 16.0 * scale / 1000000.0;
+  return (float)readShuntVoltageRaw() * scale / 1000000.0;
 }
 
 /**************************************************************************/
@@ -255,13 +544,14 @@ float Adafruit_INA2xx::getShuntVoltage_mV(void) {
 /**************************************************************************/
 /*!
     @brief Reads and scales the current value of the Power register.
+    @note This base implementation uses the INA228 power LSB of 3.2 current
+          LSBs. Adafruit_INA2xx_Chip overrides it with its traits.
     @return The current Power calculation in mW
 */
 /**************************************************************************/
 float Adafruit_INA2xx::readPower(void) {
-  Adafruit_I2CRegister power =
-      Adafruit_I2CRegister(i2c_dev, INA2XX_REG_POWER, 3, MSBFIRST);
-  return (float)power.read() * 3.2 * _current_lsb * 1000;
+  INA2XX_STATS_SCOPE(INA2XX_OP_POWER);
+  return (float)readPowerRaw() * 3.2 * _current_lsb * 1000;
 }
 
 /**************************************************************************/
@@ -274,6 +564,93 @@ float Adafruit_INA2xx::getPower_mW(void) {
   return readPower();
 }
 
+/**************************************************************************/
+/*!
+    @brief Reads the Shunt Voltage register
+    @return The sign extended 20-bit shunt voltage count
+*/
+/**************************************************************************/
+int32_t Adafruit_INA2xx::readShuntVoltageRaw(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_SHUNT_VOLTAGE);
+  uint8_t buff[INA2XX_VShuntReg::width] = {0, 0, 0};
+  _read<INA2XX_VShuntReg>(buff);
+  return _decodeSigned20(buff);
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the Bus Voltage register
+    @return The 20-bit bus voltage count
+*/
+/**************************************************************************/
+uint32_t Adafruit_INA2xx::readBusVoltageRaw(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_BUS_VOLTAGE);
+  uint8_t buff[INA2XX_VBusReg::width] = {0, 0, 0};
+  _read<INA2XX_VBusReg>(buff);
+  return _decodeUnsigned20(buff);
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the Temperature register
+    @return The 16-bit die temperature count
+*/
+/**************************************************************************/
+int16_t Adafruit_INA2xx::readDieTempRaw(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_DIE_TEMP);
+  uint8_t buff[INA2XX_DieTempReg::width] = {0, 0};
+  _read<INA2XX_DieTempReg>(buff);
+  return (int16_t)((uint16_t)buff[0] << 8 | buff[1]);
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the Current register
+    @return The sign extended 20-bit current count
+*/
+/**************************************************************************/
+int32_t Adafruit_INA2xx::readCurrentRaw(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CURRENT);
+  uint8_t buff[INA2XX_CurrentReg::width] = {0, 0, 0};
+  _read<INA2XX_CurrentReg>(buff);
+  return _decodeSigned20(buff);
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the Power register
+    @return The 24-bit power count
+*/
+/**************************************************************************/
+uint32_t Adafruit_INA2xx::readPowerRaw(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_POWER);
+  uint8_t buff[INA2XX_PowerReg::width] = {0, 0, 0};
+  _read<INA2XX_PowerReg>(buff);
+  return (uint32_t)buff[0] << 16 | (uint32_t)buff[1] << 8 | buff[2];
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the current using the fixed-point scale set by setShunt
+    @return The current current measurement in uA
+*/
+/**************************************************************************/
+int32_t Adafruit_INA2xx::readCurrent_uA(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CURRENT);
+  return _applyScale(readCurrentRaw(), _current_scale);
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads the power using the fixed-point scale set by setShunt
+    @return The current Power calculation in uW
+*/
+/**************************************************************************/
+int64_t Adafruit_INA2xx::readPower_uW(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_POWER);
+  return _applyScale(readPowerRaw(), _power_scale);
+}
+
 /**************************************************************************/
 /*!
     @brief Returns the current measurement mode
@@ -281,8 +658,7 @@ float Adafruit_INA2xx::getPower_mW(void) {
 */
 /**************************************************************************/
 INA2XX_MeasurementMode Adafruit_INA2xx::getMode(void) {
-  Adafruit_I2CRegisterBits mode = Adafruit_I2CRegisterBits(ADC_Config, 4, 12);
-  return (INA2XX_MeasurementMode)mode.read();
+  return (INA2XX_MeasurementMode)_readRegisterBits(INA2XX_REG_ADCCFG, 4, 12);
 }
 /**************************************************************************/
 /*!
@@ -292,8 +668,7 @@ INA2XX_MeasurementMode Adafruit_INA2xx::getMode(void) {
 */
 /**************************************************************************/
 void Adafruit_INA2xx::setMode(INA2XX_MeasurementMode new_mode) {
-  Adafruit_I2CRegisterBits mode = Adafruit_I2CRegisterBits(ADC_Config, 4, 12);
-  mode.write(new_mode);
+  _writeRegisterBits(INA2XX_REG_ADCCFG, 4, 12, new_mode);
 }
 /**************************************************************************/
 /*!
@@ -302,9 +677,7 @@ void Adafruit_INA2xx::setMode(INA2XX_MeasurementMode new_mode) {
 */
 /**************************************************************************/
 INA2XX_AveragingCount Adafruit_INA2xx::getAveragingCount(void) {
-  Adafruit_I2CRegisterBits averaging_count =
-      Adafruit_I2CRegisterBits(ADC_Config, 3, 0);
-  return (INA2XX_AveragingCount)averaging_count.read();
+  return (INA2XX_AveragingCount)_readRegisterBits(INA2XX_REG_ADCCFG, 3, 0);
 }
 /**************************************************************************/
 /*!
@@ -314,9 +687,7 @@ INA2XX_AveragingCount Adafruit_INA2xx::getAveragingCount(void) {
 */
 /**************************************************************************/
 void Adafruit_INA2xx::setAveragingCount(INA2XX_AveragingCount count) {
-  Adafruit_I2CRegisterBits averaging_count =
-      Adafruit_I2CRegisterBits(ADC_Config, 3, 0);
-  averaging_count.write(count);
+  _writeRegisterBits(INA2XX_REG_ADCCFG, 3, 0, count);
 }
 /**************************************************************************/
 /*!
@@ -325,9 +696,7 @@ void Adafruit_INA2xx::setAveragingCount(INA2XX_AveragingCount count) {
 */
 /**************************************************************************/
 INA2XX_ConversionTime Adafruit_INA2xx::getCurrentConversionTime(void) {
-  Adafruit_I2CRegisterBits current_conversion_time =
-      Adafruit_I2CRegisterBits(ADC_Config, 3, 6);
-  return (INA2XX_ConversionTime)current_conversion_time.read();
+  return (INA2XX_ConversionTime)_readRegisterBits(INA2XX_REG_ADCCFG, 3, 6);
 }
 /**************************************************************************/
 /*!
@@ -337,9 +706,7 @@ INA2XX_ConversionTime Adafruit_INA2xx::getCurrentConversionTime(void) {
 */
 /**************************************************************************/
 void Adafruit_INA2xx::setCurrentConversionTime(INA2XX_ConversionTime time) {
-  Adafruit_I2CRegisterBits current_conversion_time =
-      Adafruit_I2CRegisterBits(ADC_Config, 3, 6);
-  current_conversion_time.write(time);
+  _writeRegisterBits(INA2XX_REG_ADCCFG, 3, 6, time);
 }
 /**************************************************************************/
 /*!
@@ -348,9 +715,7 @@ void Adafruit_INA2xx::setCurrentConversionTime(INA2XX_ConversionTime time) {
 */
 /**************************************************************************/
 INA2XX_ConversionTime Adafruit_INA2xx::getVoltageConversionTime(void) {
-  Adafruit_I2CRegisterBits voltage_conversion_time =
-      Adafruit_I2CRegisterBits(ADC_Config, 3, 9);
-  return (INA2XX_ConversionTime)voltage_conversion_time.read();
+  return (INA2XX_ConversionTime)_readRegisterBits(INA2XX_REG_ADCCFG, 3, 9);
 }
 /**************************************************************************/
 /*!
@@ -360,9 +725,7 @@ INA2XX_ConversionTime Adafruit_INA2xx::getVoltageConversionTime(void) {
 */
 /**************************************************************************/
 void Adafruit_INA2xx::setVoltageConversionTime(INA2XX_ConversionTime time) {
-  Adafruit_I2CRegisterBits voltage_conversion_time =
-      Adafruit_I2CRegisterBits(ADC_Config, 3, 9);
-  voltage_conversion_time.write(time);
+  _writeRegisterBits(INA2XX_REG_ADCCFG, 3, 9, time);
 }
 /**************************************************************************/
 /*!
@@ -371,9 +734,7 @@ void Adafruit_INA2xx::setVoltageConversionTime(INA2XX_ConversionTime time) {
 */
 /**************************************************************************/
 INA2XX_ConversionTime Adafruit_INA2xx::getTemperatureConversionTime(void) {
-  Adafruit_I2CRegisterBits temperature_conversion_time =
-      Adafruit_I2CRegisterBits(ADC_Config, 3, 3);
-  return (INA2XX_ConversionTime)temperature_conversion_time.read();
+  return (INA2XX_ConversionTime)_readRegisterBits(INA2XX_REG_ADCCFG, 3, 3);
 }
 /**************************************************************************/
 /*!
@@ -383,21 +744,56 @@ INA2XX_ConversionTime Adafruit_INA2xx::getTemperatureConversionTime(void) {
 */
 /**************************************************************************/
 void Adafruit_INA2xx::setTemperatureConversionTime(INA2XX_ConversionTime time) {
-  Adafruit_I2CRegisterBits temperature_conversion_time =
-      Adafruit_I2CRegisterBits(ADC_Config, 3, 3);
-  temperature_conversion_time.write(time);
+  _writeRegisterBits(INA2XX_REG_ADCCFG, 3, 3, time);
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads DIAG_ALRT once and decodes every flag and setting. Latched
+    flags seen by earlier reads that nobody asked for yet are included, so
+    no event gets lost, and are cleared afterwards.
+    @param status
+          Filled in with the decoded register
+    @return True if the register was read
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::readStatus(INA2XX_Status& status) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_STATUS);
+  uint16_t diag;
+  if (!_readDiag(&diag)) {
+    return false;
+  }
+  _diag_pending = 0;
+  status.raw = diag;
+  status.conversion_ready = diag & 0x0002;
+  status.memory_ok = diag & 0x0001;
+  status.math_overflow = diag & 0x0200;
+  status.energy_overflow = diag & 0x0800;
+  status.charge_overflow = diag & 0x0400;
+  status.limits = diag & INA2XX_LIMIT_ALL;
+  status.latch = (INA2XX_AlertLatch)((diag >> 15) & 1);
+  status.conversion_ready_alert = diag & 0x4000;
+  status.slow_alert = diag & 0x2000;
+  status.polarity = (INA2XX_AlertPolarity)((diag >> 12) & 1);
+  return true;
 }
 
 /**************************************************************************/
 /*!
-    @brief Checks if the most recent one shot measurement has completed
+    @brief Checks if the most recent one shot measurement has completed.
+    Only CNVRF is taken, limit flags read along with it stay pending for
+    readStatus() and readLimitEvents().
     @return true if the conversion has completed
 */
 /**************************************************************************/
 bool Adafruit_INA2xx::conversionReady(void) {
-  Adafruit_I2CRegisterBits conversion_ready =
-      Adafruit_I2CRegisterBits(Diag_Alert, 1, 1);
-  return conversion_ready.read();
+  INA2XX_STATS_SCOPE(INA2XX_OP_STATUS);
+  uint16_t diag;
+  if (!_readDiag(&diag) || !(diag & 0x0002)) {
+    return false;
+  }
+  _diag_pending &= ~0x02;
+  return true;
 }
 
 /**************************************************************************/
@@ -407,9 +803,7 @@ bool Adafruit_INA2xx::conversionReady(void) {
 */
 /**************************************************************************/
 INA2XX_AlertPolarity Adafruit_INA2xx::getAlertPolarity(void) {
-  Adafruit_I2CRegisterBits alert_polarity =
-      Adafruit_I2CRegisterBits(Diag_Alert, 1, 12);
-  return (INA2XX_AlertPolarity)alert_polarity.read();
+  return (INA2XX_AlertPolarity)_readRegisterBits(INA2XX_REG_DIAGALRT, 1, 12);
 }
 /**************************************************************************/
 /*!
@@ -419,9 +813,7 @@ INA2XX_AlertPolarity Adafruit_INA2xx::getAlertPolarity(void) {
 */
 /**************************************************************************/
 void Adafruit_INA2xx::setAlertPolarity(INA2XX_AlertPolarity polarity) {
-  Adafruit_I2CRegisterBits alert_polarity =
-      Adafruit_I2CRegisterBits(Diag_Alert, 1, 12);
-  alert_polarity.write(polarity);
+  _writeRegisterBits(INA2XX_REG_DIAGALRT, 1, 12, polarity);
 }
 /**************************************************************************/
 /*!
@@ -430,9 +822,7 @@ void Adafruit_INA2xx::setAlertPolarity(INA2XX_AlertPolarity polarity) {
 */
 /**************************************************************************/
 INA2XX_AlertLatch Adafruit_INA2xx::getAlertLatch(void) {
-  Adafruit_I2CRegisterBits alert_latch =
-      Adafruit_I2CRegisterBits(Diag_Alert, 1, 15);
-  return (INA2XX_AlertLatch)alert_latch.read();
+  return (INA2XX_AlertLatch)_readRegisterBits(INA2XX_REG_DIAGALRT, 1, 15);
 }
 /**************************************************************************/
 /*!
@@ -442,18 +832,721 @@ INA2XX_AlertLatch Adafruit_INA2xx::getAlertLatch(void) {
 */
 /**************************************************************************/
 void Adafruit_INA2xx::setAlertLatch(INA2XX_AlertLatch state) {
-  Adafruit_I2CRegisterBits alert_latch =
-      Adafruit_I2CRegisterBits(Diag_Alert, 1, 15);
-  alert_latch.write(state);
+  _writeRegisterBits(INA2XX_REG_DIAGALRT, 1, 15, state);
 }
 /**************************************************************************/
 /*!
-    @brief Reads the alert function flags from DIAG_ALRT
+    @brief Reads the alert function flags from DIAG_ALRT, pending latched
+    flags included, and clears them
     @return Bits that indicate alert flags
 */
 /**************************************************************************/
 uint16_t Adafruit_INA2xx::alertFunctionFlags(void) {
-  Adafruit_I2CRegisterBits alert_flags =
-      Adafruit_I2CRegisterBits(Diag_Alert, 12, 0);
-  return alert_flags.read();
-}
\ No newline at end of file
+  INA2XX_STATS_SCOPE(INA2XX_OP_STATUS);
+  INA2XX_Status status;
+  if (!readStatus(status)) {
+    return 0;
+  }
+  return status.raw & 0x0FFF;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads which limit comparators have tripped, including flags
+    picked up by earlier DIAG_ALRT reads, and clears them. CNVRF stays
+    pending for conversionReady().
+    @return INA2XX_LimitEvent bits OR'd together, 0 if no limit tripped
+*/
+/**************************************************************************/
+uint8_t Adafruit_INA2xx::readLimitEvents(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_STATUS);
+  uint16_t diag;
+  if (!_readDiag(&diag)) {
+    return 0;
+  }
+  _diag_pending &= ~INA2XX_LIMIT_ALL;
+  return diag & INA2XX_LIMIT_ALL;
+}
+
+/**************************************************************************/
+/*!
+    @brief Enables or disables the host-side register cache. While enabled,
+    CONFIG, ADC_CONFIG, SHUNT_CAL and the DIAG_ALRT control bits are kept in
+    memory: getters don't touch the bus and setters do a single write
+    instead of a read-modify-write.
+    @note Only use the cache if nothing else writes to the chip, otherwise
+    call resync() after the chip may have been changed.
+    @param enable
+          True to enable the cache, false to go back to reading the chip
+    @return True if the cache state was changed successfully
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::enableRegisterCache(bool enable) {
+  _cache_enabled = false;
+  if (!enable) {
+    return true;
+  }
+  if (!resync()) {
+    return false;
+  }
+  _cache_enabled = true;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Refreshes the register cache from the chip
+    @note Reading DIAG_ALRT clears any latched alert flags
+    @return True if all registers were read successfully
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::resync(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+  uint8_t buff[2];
+
+  if (!_readRegister(INA2XX_REG_CONFIG, buff, 2)) {
+    return false;
+  }
+  _config_cache = ((uint16_t)buff[0] << 8 | buff[1]) & INA2XX_CONFIG_CACHE_MASK;
+  if (!_readRegister(INA2XX_REG_ADCCFG, buff, 2)) {
+    return false;
+  }
+  _adc_config_cache = (uint16_t)buff[0] << 8 | buff[1];
+  if (!_readRegister(INA2XX_REG_SHUNTCAL, buff, 2)) {
+    return false;
+  }
+  _shunt_cal_cache = (uint16_t)buff[0] << 8 | buff[1];
+  if (!_readRegister(INA2XX_REG_DIAGALRT, buff, 2)) {
+    return false;
+  }
+  _diag_alert_cache =
+      ((uint16_t)buff[0] << 8 | buff[1]) & INA2XX_DIAGALRT_CACHE_MASK;
+  _conversion_period = _conversionMicros(_adc_config_cache);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Looks up the cache slot backing a register
+    @param reg
+          The register address
+    @param mask
+          Set to the bits of the register that are held in the cache
+    @return Pointer to the cached value, or NULL if the cache is disabled or
+    the register is not cached
+*/
+/**************************************************************************/
+uint16_t* Adafruit_INA2xx::_cacheFor(uint8_t reg, uint16_t* mask) {
+  if (!_cache_enabled) {
+    return NULL;
+  }
+  switch (reg) {
+  case INA2XX_REG_CONFIG:
+    *mask = INA2XX_CONFIG_CACHE_MASK;
+    return &_config_cache;
+  case INA2XX_REG_ADCCFG:
+    *mask = INA2XX_ADCCFG_CACHE_MASK;
+    return &_adc_config_cache;
+  case INA2XX_REG_SHUNTCAL:
+    *mask = 0xFFFF;
+    return &_shunt_cal_cache;
+  case INA2XX_REG_DIAGALRT:
+    *mask = INA2XX_DIAGALRT_CACHE_MASK;
+    return &_diag_alert_cache;
+  default:
+    return NULL;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads a bit field, from the cache when possible
+    @param reg
+          The register address
+    @param bits
+          Width of the field
+    @param shift
+          Position of the lowest bit of the field
+    @return The field value
+*/
+/**************************************************************************/
+uint16_t Adafruit_INA2xx::_readRegisterBits(uint8_t reg, uint8_t bits,
+                                            uint8_t shift) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+  uint16_t field = ((1UL << bits) - 1) << shift;
+  uint16_t mask;
+  uint16_t* cache = _cacheFor(reg, &mask);
+  if (cache && (field & mask) == field) {
+    return (*cache & field) >> shift;
+  }
+  uint8_t buff[2] = {0, 0};
+  _readRegister(reg, buff, 2);
+  return (((uint16_t)buff[0] << 8 | buff[1]) & field) >> shift;
+}
+
+/**************************************************************************/
+/*!
+    @brief Writes a bit field. With the cache enabled the new register value
+    is built from the cache and written once, otherwise the register is
+    read, modified and written back.
+    @param reg
+          The register address
+    @param bits
+          Width of the field
+    @param shift
+          Position of the lowest bit of the field
+    @param value
+          The new field value
+    @return True if the register was read (unless cached) and written
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::_writeRegisterBits(uint8_t reg, uint8_t bits,
+                                         uint8_t shift, uint16_t value) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+  uint16_t field = ((1UL << bits) - 1) << shift;
+  uint16_t mask;
+  uint16_t current;
+  uint16_t* cache = _cacheFor(reg, &mask);
+  if (cache) {
+    current = *cache;
+  } else {
+    uint8_t buff[2];
+    if (!_readRegister(reg, buff, 2)) {
+      return false;
+    }
+    current = (uint16_t)buff[0] << 8 | buff[1];
+  }
+  return _writeRegister(reg, (current & ~field) | ((value << shift) & field));
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads a register into a buffer in a single pointer write plus
+    read transaction, without building a register object
+    @param reg
+          The register address
+    @param buffer
+          Buffer to hold the register bytes, MSB first
+    @param len
+          Width of the register in bytes
+    @return True if the transaction succeeded
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::_readRegister(uint8_t reg, uint8_t* buffer,
+                                    uint8_t len) {
+#ifdef INA2XX_ENABLE_STATS
+  uint32_t start = micros();
+  bool ok = _transport->writeThenRead(&reg, 1, buffer, len);
+  _recordTransaction(1 + len, ok, start);
+#else
+  bool ok = _transport->writeThenRead(&reg, 1, buffer, len);
+#endif
+  if (ok && reg == INA2XX_REG_DIAGALRT && len == 2) {
+    // the read may have cleared latched flags, keep them for the status
+    // queries no matter who read the register
+    _diag_pending |= buffer[1] & INA2XX_DIAGALRT_LATCHED_MASK;
+    if (buffer[1] & 0x02) {
+      markConversion(micros());
+    }
+  }
+  return ok;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads DIAG_ALRT with the pending latched flags merged in
+    @param diag
+          Set to the register value
+    @return True if the register was read
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::_readDiag(uint16_t* diag) {
+  uint8_t buff[INA2XX_DiagAlrtReg::width];
+  if (!_read<INA2XX_DiagAlrtReg>(buff)) {
+    return false;
+  }
+  *diag = (uint16_t)buff[0] << 8 | buff[1] | _diag_pending;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads a batch of result registers. Transports that can queue
+    transfers, like the Linux one, do the whole batch in one go.
+    @note Not for DIAG_ALRT, whose latched flags would be missed
+    @param reads
+          The registers to read
+    @param count
+          Number of entries in reads
+    @return True if every read succeeded
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::_readRegisters(INA2xx_RegisterRead* reads,
+                                     uint8_t count) {
+#ifdef INA2XX_ENABLE_STATS
+  uint32_t start = micros();
+  bool ok = _transport->readRegisters(reads, count);
+  uint8_t bytes = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    bytes += 1 + reads[i].len;
+  }
+  // each register is its own pointer write plus read, even in one batch
+  _recordTransaction(bytes, ok, start, count);
+  return ok;
+#else
+  return _transport->readRegisters(reads, count);
+#endif
+}
+
+/**************************************************************************/
+/*!
+    @brief Starts an asynchronous batch of reads on this device, through
+    the scheduler if one is set
+    @param transfer
+          The transfer, transport is filled in. It must not be pending.
+    @return True if the transfer was started or queued, then its done
+    callback will run exactly once
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::_startTransfer(INA2xx_Transfer* transfer) {
+  if (!_transport || transfer->pending) {
+    return false;
+  }
+  transfer->transport = _transport;
+  if (_scheduler) {
+    return _scheduler->submit(transfer);
+  }
+  if (_transport->busy()) {
+    return false;
+  }
+  transfer->pending = true;
+  if (!_transport->startTransfer(transfer)) {
+    transfer->pending = false;
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Recomputes the fixed-point current and power scales from
+    _current_lsb. Called once whenever the calibration changes.
+    @note Uses the INA228 power LSB of 3.2 current LSBs, like the base
+          setShunt(). Adafruit_INA2xx_Chip sets both scales from its traits.
+*/
+/**************************************************************************/
+void Adafruit_INA2xx::_updateScales(void) {
+  _current_scale = _makeScale(_current_lsb * 1e6);
+  _power_scale = _makeScale(3.2 * _current_lsb * 1e6);
+}
+
+/**************************************************************************/
+/*!
+    @brief Decodes a signed 20-bit result from a 3 byte register
+    @param buffer
+          The register bytes, MSB first. The low 4 bits are reserved.
+    @return The sign extended value
+*/
+/**************************************************************************/
+int32_t Adafruit_INA2xx::_decodeSigned20(const uint8_t* buffer) {
+  int32_t v = _decodeUnsigned20(buffer);
+  if (v & 0x80000)
+    v |= 0xFFF00000;
+  return v;
+}
+
+/**************************************************************************/
+/*!
+    @brief Decodes an unsigned 20-bit result from a 3 byte register
+    @param buffer
+          The register bytes, MSB first. The low 4 bits are reserved.
+    @return The value
+*/
+/**************************************************************************/
+uint32_t Adafruit_INA2xx::_decodeUnsigned20(const uint8_t* buffer) {
+  return (uint32_t)buffer[0] << 12 | (uint32_t)buffer[1] << 4 | buffer[2] >> 4;
+}
+
+/**************************************************************************/
+/*!
+    @brief Builds a fixed-point multiplier, using as many of its 32 bits as
+    possible for precision. Works in double, so the multiplier keeps more
+    digits than a float LSB has; where double is 32 bits, as on AVR, it
+    is only as precise as a float.
+    @param units_per_lsb
+          Output units for one LSB of the raw register value
+    @return The multiplier and shift pair
+*/
+/**************************************************************************/
+INA2XX_FixedScale Adafruit_INA2xx::_makeScale(double units_per_lsb) {
+  INA2XX_FixedScale scale;
+  double scaled = units_per_lsb * 4294967296.0;
+  scale.shift = 32;
+  // keep clear of 2^32 so rounding can't overflow the multiplier
+  while (scale.shift > 0 && scaled >= 4294967040.0) {
+    scaled /= 2;
+    scale.shift--;
+  }
+  if (scaled >= 4294967040.0) {
+    scaled = 4294967040.0;
+  }
+  scale.mult = scaled + 0.5;
+  return scale;
+}
+
+/**************************************************************************/
+/*!
+    @brief Converts a raw register value with a fixed-point multiplier
+    @param raw
+          The raw value, up to 40 bits plus sign
+    @param scale
+          The multiplier from _makeScale
+    @return The scaled value, truncated towards zero
+*/
+/**************************************************************************/
+int64_t Adafruit_INA2xx::_applyScale(int64_t raw,
+                                     const INA2XX_FixedScale& scale) {
+  bool negative = raw < 0;
+  uint64_t mag = negative ? -(uint64_t)raw : raw;
+  // split in two 32x32 products so a 40-bit value can't overflow
+  uint64_t result = ((mag & 0xFFFFFFFF) * scale.mult) >> scale.shift;
+  uint32_t high = mag >> 32;
+  if (high) {
+    result += ((uint64_t)high * scale.mult) << (32 - scale.shift);
+  }
+  return negative ? -(int64_t)result : (int64_t)result;
+}
+
+/**************************************************************************/
+/*!
+    @brief Writes a whole 16-bit register and keeps the cache in step
+    @param reg
+          The register address
+    @param value
+          The new register value
+    @return True if the write succeeded
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::_writeRegister(uint8_t reg, uint16_t value) {
+  uint8_t buffer[3] = {reg, (uint8_t)(value >> 8), (uint8_t)value};
+#ifdef INA2XX_ENABLE_STATS
+  uint32_t start = micros();
+  bool ok = _transport->write(buffer, 3);
+  _recordTransaction(3, ok, start);
+  if (!ok) {
+    return false;
+  }
+#else
+  if (!_transport->write(buffer, 3)) {
+    return false;
+  }
+#endif
+  uint16_t mask;
+  uint16_t* cache = _cacheFor(reg, &mask);
+  if (cache) {
+    *cache = value & mask;
+  }
+  if (reg == INA2XX_REG_ADCCFG) {
+    _adcConfigChanged();
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Computes how long one conversion takes for an ADC_CONFIG value:
+    the conversion times of the enabled channels, times the averaging count
+    @param adc_config
+          ADC_CONFIG register value
+    @return Conversion time in us, 0 in shutdown
+*/
+/**************************************************************************/
+uint32_t Adafruit_INA2xx::_conversionMicros(uint16_t adc_config) {
+  static const uint16_t times[] = {50, 84, 150, 280, 540, 1052, 2074, 4120};
+  static const uint16_t counts[] = {1, 4, 16, 64, 128, 256, 512, 1024};
+  uint8_t mode = adc_config >> 12;
+
+  uint32_t per_sample = 0;
+  if (mode & 0x1) { // bus voltage
+    per_sample += times[(adc_config >> 9) & 0x7];
+  }
+  if (mode & 0x2) { // shunt voltage
+    per_sample += times[(adc_config >> 6) & 0x7];
+  }
+  if (mode & 0x4) { // temperature
+    per_sample += times[(adc_config >> 3) & 0x7];
+  }
+  return per_sample * counts[adc_config & 0x7];
+}
+
+/**************************************************************************/
+/*!
+    @brief Starts a conversion without waiting for it. Follow up with poll()
+    until it returns INA2XX_CONVERSION_READY, then fetch result().
+    @param mode
+          The (triggered) mode to start. Writing it starts a new conversion.
+    @return True if the conversion was started
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::startConversion(INA2XX_MeasurementMode mode) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONVERSION);
+  uint16_t adc_config = _readRegisterBits(INA2XX_REG_ADCCFG, 16, 0);
+  adc_config = (adc_config & 0x0FFF) | ((uint16_t)mode << 12);
+  if (!_writeRegister(INA2XX_REG_ADCCFG, adc_config)) {
+    _conversion_state = INA2XX_CONVERSION_IDLE;
+    return false;
+  }
+
+  // a CNVRF picked up by an earlier DIAG_ALRT read belongs to an older
+  // conversion, don't let poll() take it for this one
+  _diag_pending &= ~0x02;
+  _conversion_start = micros();
+  _conversion_time = _conversionMicros(adc_config);
+  _conversion_poll_at = _conversion_time;
+  _conversion_state = INA2XX_CONVERSION_PENDING;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Advances a conversion started with startConversion(). Never
+    blocks, and does no bus I/O until the modelled conversion time has
+    passed.
+    @return The conversion state
+*/
+/**************************************************************************/
+INA2XX_ConversionState Adafruit_INA2xx::poll(void) {
+  INA2XX_STATS_SCOPE(INA2XX_OP_CONVERSION);
+  if (_conversion_state != INA2XX_CONVERSION_PENDING) {
+    return _conversion_state;
+  }
+  uint32_t elapsed = micros() - _conversion_start;
+  if (elapsed < _conversion_poll_at) {
+    return _conversion_state;
+  }
+
+  if (!conversionReady()) {
+    // give up after twice the modelled time plus some slack
+    if (elapsed > 2 * _conversion_time + 10000) {
+      _conversion_state = INA2XX_CONVERSION_TIMEOUT;
+    } else {
+      _conversion_poll_at = elapsed + _conversion_time / 16 + 50;
+    }
+    return _conversion_state;
+  }
+
+  _measurement.timestamp_us = micros();
+  _measurement.bus_voltage_V = readBusVoltage();
+  _measurement.shunt_voltage_mV = readShuntVoltage();
+  _measurement.current_mA = readCurrent();
+  _measurement.power_mW = readPower();
+  _measurement.die_temp_C = readDieTemp();
+  _conversion_state = INA2XX_CONVERSION_READY;
+  return _conversion_state;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the readings of the last completed conversion
+    @return The measurement, valid once poll() returned
+    INA2XX_CONVERSION_READY
+*/
+/**************************************************************************/
+const INA2XX_Measurement& Adafruit_INA2xx::result(void) {
+  return _measurement;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns the earliest time the pending conversion can be done
+    @return micros() value at which poll() will first check the chip
+*/
+/**************************************************************************/
+uint32_t Adafruit_INA2xx::conversionReadyAt(void) {
+  return _conversion_start + _conversion_poll_at;
+}
+
+/**************************************************************************/
+/*!
+    @brief Updates the conversion model after ADC_CONFIG was written. The
+    chip restarts its conversion cycle on the write.
+*/
+/**************************************************************************/
+void Adafruit_INA2xx::_adcConfigChanged(void) {
+  _conversion_anchor = micros();
+  // without the cache the new value is unknown until it is read back
+  _conversion_period =
+      _cache_enabled ? _conversionMicros(_adc_config_cache) : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief Returns how often a new result is produced in continuous mode,
+    from the averaging count and the conversion times of the enabled
+    channels. With the register cache this never touches the bus.
+    @return Conversion period in us, 0 in shutdown
+*/
+/**************************************************************************/
+uint32_t Adafruit_INA2xx::conversionPeriodMicros(void) {
+  if (!_conversion_period) {
+    _conversion_period =
+        _conversionMicros(_readRegisterBits(INA2XX_REG_ADCCFG, 16, 0));
+  }
+  return _conversion_period;
+}
+
+/**************************************************************************/
+/*!
+    @brief Records a time at which a conversion completed, for example an
+    ALERT edge or a snapshot timestamp. Later conversions are predicted
+    from it. Every DIAG_ALRT read calls this when it sees CNVRF set.
+    @param timestamp_us
+          micros() value of the conversion boundary
+*/
+/**************************************************************************/
+void Adafruit_INA2xx::markConversion(uint32_t timestamp_us) {
+  _conversion_anchor = timestamp_us;
+}
+
+/**************************************************************************/
+/*!
+    @brief Predicts when the next result will be available
+    @return micros() value of the next conversion boundary
+*/
+/**************************************************************************/
+uint32_t Adafruit_INA2xx::nextConversionAt(void) {
+  return micros() + microsUntilNextConversion();
+}
+
+/**************************************************************************/
+/*!
+    @brief Predicts how long until the next result will be available, so
+    reads can be lined up with conversion boundaries instead of re-reading
+    stale registers
+    @return Time to the next conversion boundary in us
+*/
+/**************************************************************************/
+uint32_t Adafruit_INA2xx::microsUntilNextConversion(void) {
+  uint32_t period = conversionPeriodMicros();
+  if (!period) {
+    return 0;
+  }
+  uint32_t elapsed = micros() - _conversion_anchor;
+  return period - elapsed % period;
+}
+
+/**************************************************************************/
+/*!
+    @brief Checks whether a conversion boundary has passed since a reading
+    was taken, meaning the result registers hold fresh data
+    @param timestamp_us
+          micros() value when the previous reading was taken
+    @return True if a new result should be available
+*/
+/**************************************************************************/
+bool Adafruit_INA2xx::newConversionSince(uint32_t timestamp_us) {
+  uint32_t period = conversionPeriodMicros();
+  if (!period) {
+    return false;
+  }
+  if ((int32_t)(timestamp_us - _conversion_anchor) < 0) {
+    return true; // the anchor itself is a newer boundary
+  }
+  // compare the number of boundaries since the anchor at both times
+  return (micros() - _conversion_anchor) / period !=
+         (timestamp_us - _conversion_anchor) / period;
+}
+
+#ifdef INA2XX_ENABLE_STATS
+/**************************************************************************/
+/*!
+    @brief Returns the bus statistics collected for one operation
+    @param op
+          The operation
+    @return The statistics since construction or the last resetStats()
+*/
+/**************************************************************************/
+const INA2XX_OpStats& Adafruit_INA2xx::stats(INA2XX_Op op) {
+  if (op >= INA2XX_OP_COUNT) {
+    op = INA2XX_OP_CONFIG;
+  }
+  return _stats[op];
+}
+
+/**************************************************************************/
+/*!
+    @brief Clears the statistics of all operations
+*/
+/**************************************************************************/
+void Adafruit_INA2xx::resetStats(void) {
+  memset(_stats, 0, sizeof(_stats));
+}
+
+/**************************************************************************/
+/*!
+    @brief Charges I2C transactions to the operation in progress.
+    Transactions outside of any operation are charged to INA2XX_OP_CONFIG.
+    @param bytes
+          Bytes moved, including the register pointers
+    @param ok
+          True if the transactions succeeded. A failed batch counts as one
+          failure, the transport doesn't say which read failed.
+    @param start
+          micros() when the first transaction started
+    @param count
+          Transactions issued back to back, such as the reads of a batch
+*/
+/**************************************************************************/
+void Adafruit_INA2xx::_recordTransaction(uint8_t bytes, bool ok,
+                                         uint32_t start, uint8_t count) {
+  INA2XX_OpStats& s =
+      _stats[_stats_op < INA2XX_OP_COUNT ? _stats_op : INA2XX_OP_CONFIG];
+  s.transactions += count;
+  s.bytes += bytes;
+  s.bus_time_us += micros() - start;
+  if (!ok) {
+    s.failures++;
+  }
+}
+
+/*!
+ *    @brief  Starts charging bus traffic to an operation, unless an outer
+ *            scope is already active
+ *    @param  dev
+ *            The driver doing the traffic
+ *    @param  op
+ *            The operation to charge
+ */
+INA2XX_StatsScope::INA2XX_StatsScope(Adafruit_INA2xx* dev, INA2XX_Op op)
+    : _dev(dev), _start(0), _outer(dev->_stats_op == INA2XX_OP_COUNT) {
+  if (_outer) {
+    dev->_stats_op = op;
+    _start = micros();
+  }
+}
+
+/*!
+ *    @brief  Counts the call and its latency if this was the outermost scope
+ */
+INA2XX_StatsScope::~INA2XX_StatsScope() {
+  if (!_outer) {
+    return;
+  }
+  uint32_t latency = micros() - _start;
+  INA2XX_OpStats& s = _dev->_stats[_dev->_stats_op];
+  _dev->_stats_op = INA2XX_OP_COUNT;
+
+  if (!s.calls || latency < s.min_latency_us) {
+    s.min_latency_us = latency;
+  }
+  if (latency > s.max_latency_us) {
+    s.max_latency_us = latency;
+  }
+  s.calls++;
+  uint8_t bucket = 0;
+  while (bucket < INA2XX_STATS_BUCKETS - 1 && latency >= (64UL << bucket)) {
+    bucket++;
+  }
+  s.histogram[bucket]++;
+}
+#endif
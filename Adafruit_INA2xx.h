@@ -17,11 +17,13 @@
 #ifndef _ADAFRUIT_INA2XX_H
 #define _ADAFRUIT_INA2XX_H
 
-#include <Adafruit_I2CDevice.h>
-#include <Adafruit_I2CRegister.h>
-#include <Wire.h>
+#include "Adafruit_INA2xx_Platform.h"
+#include "Adafruit_INA2xx_Scheduler.h"
+#include "Adafruit_INA2xx_Transport.h"
 
-#include "Arduino.h"
+#if defined(ARDUINO)
+#include "Adafruit_INA2xx_ArduinoTransport.h"
+#endif
 
 // Common registers for INA2xx family
 #define INA2XX_REG_CONFIG 0x00    ///< Configuration register
@@ -44,6 +46,21 @@
 
 #define INA2XX_I2CADDR_DEFAULT 0x40 ///< INA2xx default i2c address
 
+// Power-on defaults, used to re-seed the register cache after a reset
+#define INA2XX_CONFIG_DEFAULT 0x0000   ///< CONFIG power-on value
+#define INA2XX_ADCCFG_DEFAULT 0xFB68   ///< ADC_CONFIG power-on value
+#define INA2XX_SHUNTCAL_DEFAULT 0x1000 ///< SHUNT_CAL power-on value
+#define INA2XX_DIAGALRT_DEFAULT 0x0001 ///< DIAG_ALRT power-on value
+
+// Bits that are kept in the register cache. CONFIG RST/RSTACC self-clear and
+// the low DIAG_ALRT bits are status flags, so neither can be cached.
+#define INA2XX_CONFIG_CACHE_MASK 0x3FFF   ///< Cacheable CONFIG bits
+#define INA2XX_ADCCFG_CACHE_MASK 0xFFFF   ///< Cacheable ADC_CONFIG bits
+#define INA2XX_DIAGALRT_CACHE_MASK 0xF000 ///< Cacheable DIAG_ALRT control bits
+// DIAG_ALRT flags that clear when read with the alert latch enabled. Every
+// read keeps them pending until a status query hands them out.
+#define INA2XX_DIAGALRT_LATCHED_MASK 0x00FE ///< CNVRF and the limit flags
+
 /**
  * @brief Mode options.
  *
@@ -148,20 +165,202 @@ typedef enum _alert_latch {
                                           cleared **/
 } INA2XX_AlertLatch;
 
+/**
+ * @brief State of a conversion started with startConversion.
+ *
+ * Values returned by poll.
+ */
+typedef enum _conversion_state {
+  INA2XX_CONVERSION_IDLE,    ///< No conversion has been started
+  INA2XX_CONVERSION_PENDING, ///< Conversion started, result not read yet
+  INA2XX_CONVERSION_READY,   ///< Result available from result()
+  INA2XX_CONVERSION_TIMEOUT, ///< The chip never reported conversion ready
+} INA2XX_ConversionState;
+
+/**
+ * @brief Limit comparators that can trip, as DIAG_ALRT flag bits.
+ *
+ * Returned OR'd together by readLimitEvents.
+ */
+typedef enum _limit_event {
+  INA2XX_LIMIT_TEMP_OVER = 0x80,   ///< Die temperature over TEMP_LIMIT
+  INA2XX_LIMIT_SHUNT_OVER = 0x40,  ///< Shunt voltage (current) over SOVL
+  INA2XX_LIMIT_SHUNT_UNDER = 0x20, ///< Shunt voltage (current) under SUVL
+  INA2XX_LIMIT_BUS_OVER = 0x10,    ///< Bus voltage over BOVL
+  INA2XX_LIMIT_BUS_UNDER = 0x08,   ///< Bus voltage under BUVL
+  INA2XX_LIMIT_POWER_OVER = 0x04,  ///< Power over PWR_LIMIT
+} INA2XX_LimitEvent;
+
+#define INA2XX_LIMIT_ALL 0xFC ///< All INA2XX_LimitEvent bits
+
+/**
+ * @brief DIAG_ALRT decoded by readStatus.
+ */
+typedef struct {
+  uint16_t raw;                  ///< Register value, pending flags included
+  bool conversion_ready;         ///< CNVRF: a conversion completed
+  bool memory_ok;                ///< MEMSTAT: trim memory checksum is good
+  bool math_overflow;            ///< MATHOF: a CURRENT/POWER result overflowed
+  bool energy_overflow;          ///< ENERGYOF: the ENERGY register overflowed
+  bool charge_overflow;          ///< CHARGEOF: the CHARGE register overflowed
+  uint8_t limits;                ///< INA2XX_LimitEvent bits that tripped
+  INA2XX_AlertLatch latch;       ///< ALATCH setting
+  bool conversion_ready_alert;   ///< CNVR: ALERT follows CNVRF
+  bool slow_alert;               ///< SLOWALERT: compare on averaged values
+  INA2XX_AlertPolarity polarity; ///< APOL setting
+} INA2XX_Status;
+
+/**
+ * @brief Readings collected by poll once a triggered conversion completes.
+ */
+typedef struct {
+  uint32_t timestamp_us;  ///< micros() when the result was read
+  float bus_voltage_V;    ///< Bus voltage in V
+  float shunt_voltage_mV; ///< Shunt voltage in mV
+  float current_mA;       ///< Current in mA
+  float power_mW;         ///< Power in mW
+  float die_temp_C;       ///< Die temperature in deg C
+} INA2XX_Measurement;
+
+/**
+ * @brief Fixed-point multiplier used by the integer read functions.
+ *
+ * A raw register value is converted with (raw * mult) >> shift.
+ */
+typedef struct {
+  uint32_t mult; ///< Output units per LSB, scaled by 2^shift
+  uint8_t shift; ///< Number of fractional bits in mult, 0 to 32
+} INA2XX_FixedScale;
+
+/**
+ * @brief Compile-time description of a register.
+ *
+ * Reads through _read() get the address and width as constants, so the
+ * call is a single bus transfer into a stack buffer of the exact size.
+ */
+template <uint8_t ADDRESS, uint8_t WIDTH> struct INA2XX_Register {
+  static const uint8_t address = ADDRESS; ///< Register address
+  static const uint8_t width = WIDTH;     ///< Register width in bytes
+};
+
+typedef INA2XX_Register<INA2XX_REG_VSHUNT, 3>
+    INA2XX_VShuntReg; ///< Shunt voltage, 20-bit in 3 bytes
+typedef INA2XX_Register<INA2XX_REG_VBUS, 3>
+    INA2XX_VBusReg; ///< Bus voltage, 20-bit in 3 bytes
+typedef INA2XX_Register<INA2XX_REG_DIETEMP, 2>
+    INA2XX_DieTempReg; ///< Die temperature, 16-bit
+typedef INA2XX_Register<INA2XX_REG_CURRENT, 3>
+    INA2XX_CurrentReg; ///< Current, 20-bit in 3 bytes
+typedef INA2XX_Register<INA2XX_REG_POWER, 3>
+    INA2XX_PowerReg; ///< Power, 24-bit
+typedef INA2XX_Register<INA2XX_REG_DIAGALRT, 2>
+    INA2XX_DiagAlrtReg; ///< Diagnostic flags and alert, 16-bit
+
+/**
+ * @brief API operations that bus statistics are kept for.
+ *
+ * Only used when the library is built with INA2XX_ENABLE_STATS defined. It
+ * has to be a build flag (-DINA2XX_ENABLE_STATS) so the library and the
+ * sketch agree on the class layout; without it no code or RAM is spent.
+ */
+typedef enum _op {
+  INA2XX_OP_CONFIG,        ///< Setup, calibration and configuration access
+  INA2XX_OP_SHUNT_VOLTAGE, ///< Shunt voltage reads
+  INA2XX_OP_BUS_VOLTAGE,   ///< Bus voltage reads
+  INA2XX_OP_DIE_TEMP,      ///< Die temperature reads
+  INA2XX_OP_CURRENT,       ///< Current reads
+  INA2XX_OP_POWER,         ///< Power reads
+  INA2XX_OP_ENERGY,        ///< Energy accumulator reads
+  INA2XX_OP_CHARGE,        ///< Charge accumulator reads
+  INA2XX_OP_STATUS,        ///< Conversion ready and alert flag reads
+  INA2XX_OP_SNAPSHOT,      ///< Multi-register snapshots
+  INA2XX_OP_CONVERSION,    ///< startConversion() and poll()
+  INA2XX_OP_COUNT,         ///< Number of operations, not an operation
+} INA2XX_Op;
+
+#define INA2XX_STATS_BUCKETS 8 ///< Latency histogram buckets, 64us to 4ms+
+
+/**
+ * @brief Bus statistics collected for one API operation.
+ *
+ * Bucket n of the latency histogram counts calls that took less than
+ * 64 << n us, the last bucket also holds everything slower.
+ */
+typedef struct {
+  uint32_t calls;          ///< Number of API calls
+  uint32_t transactions;   ///< I2C transactions issued by those calls
+  uint32_t bytes;          ///< Bytes moved, including register pointers
+  uint32_t failures;       ///< Transactions that failed
+  uint32_t bus_time_us;    ///< Total time spent in transactions
+  uint32_t min_latency_us; ///< Fastest call, 0 before the first call
+  uint32_t max_latency_us; ///< Slowest call
+  uint32_t histogram[INA2XX_STATS_BUCKETS]; ///< Call latency histogram
+} INA2XX_OpStats;
+
+class Adafruit_INA2xx;
+
+#ifdef INA2XX_ENABLE_STATS
+/*!
+ *    @brief  Charges the bus traffic done while it is in scope to one
+ *            operation. Only the outermost scope counts a call, so a read
+ *            done by a snapshot is charged to the snapshot.
+ */
+class INA2XX_StatsScope {
+ public:
+  INA2XX_StatsScope(Adafruit_INA2xx* dev, INA2XX_Op op);
+  ~INA2XX_StatsScope();
+
+ private:
+  Adafruit_INA2xx* _dev;
+  uint32_t _start;
+  bool _outer;
+};
+
+/// Charges the bus traffic of the enclosing block to an operation
+#define INA2XX_STATS_SCOPE(op) INA2XX_StatsScope _stats_scope(this, op)
+#else
+/// Compiles to nothing unless INA2XX_ENABLE_STATS is defined
+#define INA2XX_STATS_SCOPE(op)
+#endif
+
 /*!
  *    @brief  Class that stores state and functions for interacting with
  *            INA2xx Current and Power Sensor
+ *
+ *    The driver never allocates from the heap: the Wire transport lives
+ *    inside the object and registers are accessed by address, so begin()
+ *    can be called again to recover from a bus fault. Any other
+ *    INA2xx_Transport, such as the Linux i2c-dev one or a simulator, can
+ *    be passed to begin() instead. The Wire overloads only exist on Arduino
+ *    targets, a host build talks through a transport.
  */
 class Adafruit_INA2xx {
  public:
   Adafruit_INA2xx();
+#if defined(ARDUINO)
   virtual bool begin(uint8_t i2c_addr = INA2XX_I2CADDR_DEFAULT,
-                     TwoWire* theWire = &Wire, bool skipReset = false);
+                     TwoWire* theWire = &Wire, bool skipReset = false,
+                     uint32_t i2c_clock = 0);
+  bool beginAsync(uint8_t i2c_addr = INA2XX_I2CADDR_DEFAULT,
+                  TwoWire* theWire = &Wire, bool skipReset = false,
+                  uint32_t i2c_clock = 0);
+#endif
+  bool begin(INA2xx_Transport* transport, bool skipReset = false);
+  virtual bool beginAsync(INA2xx_Transport* transport, bool skipReset = false);
+  INA2xx_Transport* transport(void);
+  bool setBusClock(uint32_t clock_hz);
+  uint32_t busClock(void);
+  void setScheduler(INA2xx_Scheduler* scheduler);
+  INA2XX_ConversionState startupState(void);
+  bool isReady(void);
+  void setAlertPin(int8_t pin);
   virtual void reset(void);
 
-  virtual void setShunt(float shunt_res = 0.1, float max_current = 3.2);
+  virtual bool setShunt(float shunt_res = 0.1, float max_current = 3.2);
   void setADCRange(uint8_t);
   uint8_t getADCRange(void);
+  float getShuntResistance(void);
+  float getCurrentLSB(void);
   virtual float readDieTemp(void);
   virtual float readBusVoltage(void);
 
@@ -176,11 +375,23 @@ class Adafruit_INA2xx {
   virtual float readShuntVoltage(void);
   virtual float readPower(void);
 
+  // Integer interface, no floating point math involved:
+  int32_t readShuntVoltageRaw(void);
+  uint32_t readBusVoltageRaw(void);
+  int16_t readDieTempRaw(void);
+  int32_t readCurrentRaw(void);
+  uint32_t readPowerRaw(void);
+  int32_t readCurrent_uA(void);
+  int64_t readPower_uW(void);
+  //
+
   void setMode(INA2XX_MeasurementMode mode);
   INA2XX_MeasurementMode getMode(void);
 
+  bool readStatus(INA2XX_Status& status);
   bool conversionReady(void);
   uint16_t alertFunctionFlags(void);
+  uint8_t readLimitEvents(void);
 
   INA2XX_AlertLatch getAlertLatch(void);
   void setAlertLatch(INA2XX_AlertLatch state);
@@ -196,18 +407,103 @@ class Adafruit_INA2xx {
   INA2XX_AveragingCount getAveragingCount(void);
   void setAveragingCount(INA2XX_AveragingCount count);
 
-  Adafruit_I2CRegister *Config, ///< BusIO Register for Config
-      *ADC_Config,              ///< BusIO Register for ADC Config
-      *Diag_Alert;              ///< BusIO Register for Diagnostic Alerts
+  bool enableRegisterCache(bool enable = true);
+  bool resync(void);
+
+  bool startConversion(INA2XX_MeasurementMode mode = INA2XX_MODE_TRIGGERED);
+  INA2XX_ConversionState poll(void);
+  const INA2XX_Measurement& result(void);
+  uint32_t conversionReadyAt(void);
+
+  uint32_t conversionPeriodMicros(void);
+  void markConversion(uint32_t timestamp_us);
+  uint32_t nextConversionAt(void);
+  uint32_t microsUntilNextConversion(void);
+  bool newConversionSince(uint32_t timestamp_us);
+
+#ifdef INA2XX_ENABLE_STATS
+  const INA2XX_OpStats& stats(INA2XX_Op op);
+  void resetStats(void);
+#endif
 
  protected:
-  virtual void _updateShuntCalRegister(
+  virtual bool _updateShuntCalRegister(
       void);          ///< Updates the shunt calibration register based on
                       ///< device-specific calculations
+  uint16_t _readRegisterBits(uint8_t reg, uint8_t bits, uint8_t shift);
+  bool _writeRegisterBits(uint8_t reg, uint8_t bits, uint8_t shift,
+                          uint16_t value);
+  uint16_t* _cacheFor(uint8_t reg, uint16_t* mask);
+  bool _readRegister(uint8_t reg, uint8_t* buffer, uint8_t len);
+  bool _readRegisters(INA2xx_RegisterRead* reads, uint8_t count);
+  bool _startTransfer(INA2xx_Transfer* transfer);
+  void _releaseTransport(void);
+  bool _readDiag(uint16_t* diag);
+  bool _writeRegister(uint8_t reg, uint16_t value);
+
+  /*!
+   *    @brief  Reads a register described at compile time
+   *    @param  buffer
+   *            Buffer of exactly the register width, MSB first
+   *    @return True if the transaction succeeded
+   */
+  template <typename REG> bool _read(uint8_t (&buffer)[REG::width]) {
+    return _readRegister(REG::address, buffer, REG::width);
+  }
+  static uint32_t _conversionMicros(uint16_t adc_config);
+  void _adcConfigChanged(void);
+  void _armStartup(uint16_t config, uint16_t adc_config);
+  bool _waitForStartup(void);
+  void _updateScales(void);
+  static int32_t _decodeSigned20(const uint8_t* buffer);
+  static uint32_t _decodeUnsigned20(const uint8_t* buffer);
+  static INA2XX_FixedScale _makeScale(double units_per_lsb);
+  static int64_t _applyScale(int64_t raw, const INA2XX_FixedScale& scale);
+
   float _shunt_res;   ///< Shunt resistance value in ohms
   float _current_lsb; ///< Current LSB value used for calculations
-  Adafruit_I2CDevice* i2c_dev; ///< I2C device interface
-  uint16_t _device_id;         ///< Device ID for chip verification
+  INA2XX_FixedScale _current_scale; ///< uA per CURRENT LSB
+  INA2XX_FixedScale _power_scale;   ///< uW per POWER LSB
+  INA2xx_Transport* _transport; ///< Bus interface, NULL before begin()
+#if defined(ARDUINO)
+  alignas(INA2xx_ArduinoTransport) uint8_t
+      _wire_storage[sizeof(INA2xx_ArduinoTransport)]; ///< Wire transport
+#endif
+  bool _owns_transport;         ///< True if _transport is in _wire_storage
+  INA2xx_Scheduler* _scheduler; ///< Queue for async reads, NULL for none
+  uint32_t _bus_clock;          ///< SCL in Hz from setBusClock, 0 if unset
+  uint16_t _device_id;          ///< Device ID for chip verification
+
+  bool _cache_enabled;        ///< True when getters are served from the cache
+  uint16_t _config_cache;     ///< Host copy of CONFIG
+  uint16_t _adc_config_cache; ///< Host copy of ADC_CONFIG
+  uint16_t _shunt_cal_cache;  ///< Last value written to SHUNT_CAL
+  uint16_t _diag_alert_cache; ///< Host copy of the DIAG_ALRT control bits
+  uint8_t _diag_pending;      ///< Latched flags read but not handed out
+
+  INA2XX_ConversionState _conversion_state; ///< State reported by poll()
+  uint32_t _conversion_start;   ///< micros() when the conversion started
+  uint32_t _conversion_time;    ///< Modelled conversion time in us
+  uint32_t _conversion_poll_at; ///< Earliest micros() offset for the next read
+  INA2XX_Measurement _measurement; ///< Result of the last conversion
+
+  uint32_t _conversion_period; ///< Modelled period in us, 0 if not known
+  uint32_t _conversion_anchor; ///< micros() of a known conversion boundary
+
+  INA2XX_ConversionState _startup_state; ///< State reported by startupState
+  uint32_t _startup_start;   ///< micros() when the first conversion started
+  uint32_t _startup_time;    ///< Modelled time to the first result in us
+  uint32_t _startup_poll_at; ///< Earliest micros() offset for the next read
+  int8_t _alert_pin;         ///< Pin wired to ALERT, -1 if none
+
+#ifdef INA2XX_ENABLE_STATS
+  friend class INA2XX_StatsScope;
+  void _recordTransaction(uint8_t bytes, bool ok, uint32_t start,
+                          uint8_t count = 1);
+
+  INA2XX_OpStats _stats[INA2XX_OP_COUNT]; ///< Per-operation statistics
+  INA2XX_Op _stats_op; ///< Operation being charged, INA2XX_OP_COUNT if none
+#endif
 };
 
 #endif
\ No newline at end of file
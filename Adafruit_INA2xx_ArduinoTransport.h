@@ -0,0 +1,107 @@
+/*!
+ *  @file Adafruit_INA2xx_ArduinoTransport.h
+ *
+ * 	INA2xx transport over an Arduino TwoWire bus. Only built for Arduino
+ *  targets, the rest of the driver builds on a host without it.
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA2XX_ARDUINOTRANSPORT_H
+#define _ADAFRUIT_INA2XX_ARDUINOTRANSPORT_H
+
+#if defined(ARDUINO)
+
+#include <Adafruit_I2CDevice.h>
+#include <Wire.h>
+
+#include "Adafruit_INA2xx_Transport.h"
+
+/*!
+ *    @brief  Transport over an Arduino TwoWire bus, through BusIO
+ */
+class INA2xx_ArduinoTransport : public INA2xx_Transport {
+ public:
+  /*!
+   *    @brief  Binds the transport to a device
+   *    @param  i2c_addr
+   *            The I2C address of the device
+   *    @param  theWire
+   *            The Wire object the device is on
+   */
+  INA2xx_ArduinoTransport(uint8_t i2c_addr, TwoWire* theWire)
+      : _device(i2c_addr, theWire) {}
+
+  /*!
+   *    @brief  Starts the bus and probes the address
+   *    @return True if the device acknowledged
+   */
+  bool begin(void) override {
+    return _device.begin();
+  }
+
+  /*!
+   *    @brief  Writes bytes in one transaction
+   *    @param  buffer
+   *            Bytes to send
+   *    @param  len
+   *            Number of bytes
+   *    @return True if the device acknowledged them
+   */
+  bool write(const uint8_t* buffer, size_t len) override {
+    return _device.write(buffer, len);
+  }
+
+  /*!
+   *    @brief  Writes bytes, then reads with a repeated start
+   *    @param  write_buffer
+   *            Bytes to send
+   *    @param  write_len
+   *            Number of bytes to send
+   *    @param  read_buffer
+   *            Receives the bytes read
+   *    @param  read_len
+   *            Number of bytes to read
+   *    @return True if the transaction succeeded
+   */
+  bool writeThenRead(const uint8_t* write_buffer, size_t write_len,
+                     uint8_t* read_buffer, size_t read_len) override {
+    return _device.write_then_read(write_buffer, write_len, read_buffer,
+                                   read_len);
+  }
+
+  /*!
+   *    @brief  Sets the clock of the whole Wire bus, which every device on
+   *            it shares. High-speed mode is not offered: Wire sends a stop
+   *            after the unacknowledged master code, and that ends HS.
+   *    @param  clock_hz
+   *            The SCL frequency in Hz, at most INA2XX_I2C_FAST_PLUS
+   *    @return True if the bus was set to that speed
+   */
+  bool setClock(uint32_t clock_hz) override {
+    return clock_hz <= INA2XX_I2C_FAST_PLUS && _device.setSpeed(clock_hz);
+  }
+
+  /*!
+   *    @brief  The BusIO device underneath
+   *    @return The device
+   */
+  Adafruit_I2CDevice& device(void) {
+    return _device;
+  }
+
+ private:
+  Adafruit_I2CDevice _device;
+};
+
+#endif // ARDUINO
+
+#endif
@@ -0,0 +1,524 @@
+/*!
+ *  @file Adafruit_INA2xx_Chip.h
+ *
+ * 	INA2xx driver specialized at compile time for one chip
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA2XX_CHIP_H
+#define _ADAFRUIT_INA2XX_CHIP_H
+
+#include "Adafruit_INA2xx.h"
+
+/*!
+ *    @brief  INA2xx driver with the chip specific constants taken from a
+ *            traits struct at compile time
+ *
+ *    ChipTraits provides, as compile-time constants:
+ *    - device_id: expected value of the DEVICE_ID field
+ *    - current_lsb_bits: the current LSB is max_current / 2^current_lsb_bits
+ *    - shunt_lsb_nV, shunt_lsb_shift, shunt_lsb_shift_range1: the shunt
+ *      LSB is shunt_lsb_nV >> shift nV, in ADC range 0 and 1
+ *    - bus_lsb_uV, bus_lsb_shift: the bus LSB is bus_lsb_uV >> shift uV
+ *    - temp_lsb_mC, temp_lsb_shift: the temperature LSB in m°C, likewise
+ *    - shunt_cal_range1_mult: SHUNT_CAL multiplier in ADC range 1
+ *    - limit_shift, temp_limit_shift, power_limit_shift: the SOVL/SUVL/BOVL/
+ *      BUVL, TEMP_LIMIT and PWR_LIMIT LSBs are the result LSBs << shift
+ *    - bus_limit_max, shunt_cal_max: largest BOVL/BUVL and SHUNT_CAL
+ *    - shuntCalConstant(), powerLsbFactor(): constexpr functions giving
+ *      the SHUNT_CAL constant and the power LSB in current LSBs
+ *    - shuntCal(), shuntCalRegister(), shuntCalFits(): constexpr
+ *      functions working out, rounding and checking SHUNT_CAL
+ *
+ *    All scaling folds to constants. The readers that scale a result and
+ *    the SHUNT_CAL update are final here, and setShunt() in the chip
+ *    class, so calls through the chip class are not dispatched at run
+ *    time. The Adafruit_INA2xx base keeps INA228 defaults for them so
+ *    existing code holding an Adafruit_INA2xx pointer keeps working.
+ */
+template <typename ChipTraits>
+class Adafruit_INA2xx_Chip : public Adafruit_INA2xx {
+ public:
+  typedef ChipTraits Traits; ///< The traits this driver was built for
+
+  /*!
+   *    @brief  Instantiates a new driver with no limits set
+   */
+  Adafruit_INA2xx_Chip(void)
+      : _overcurrent_limit(0), _undercurrent_limit(0), _power_limit(0),
+        _limits_set(0) {}
+
+  using Adafruit_INA2xx::beginAsync;
+
+  /*!
+   *    @brief  Sets up the HW without waiting for the first conversion and
+   *            checks the device ID. Every begin() goes through here.
+   *    @param  transport
+   *            The bus interface bound to the device.
+   *    @param  skipReset
+   *            When set to true, will omit resetting all registers to
+   *            their default values. Default: false.
+   *    @return True if the chip was found and is the expected device
+   */
+  bool beginAsync(INA2xx_Transport* transport,
+                  bool skipReset = false) override {
+    INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+    if (!Adafruit_INA2xx::beginAsync(transport, skipReset)) {
+      return false;
+    }
+    // make sure we're talking to the right chip
+    return _device_id == ChipTraits::device_id;
+  }
+
+  /*!
+   *    @brief  Resets the chip. The limit registers return to their
+   *            power-on values, so limits set earlier are forgotten.
+   */
+  void reset(void) override {
+    Adafruit_INA2xx::reset();
+    _limits_set = 0;
+  }
+
+  /*!
+   *    @brief  Reads the die temperature
+   *    @return The current die temp in deg C
+   */
+  float readDieTemp(void) final {
+    return (float)readDieTempRaw() * _dieTempLsb_C();
+  }
+
+  /*!
+   *    @brief  Reads the bus voltage
+   *    @return The current bus voltage measurement in V
+   */
+  float readBusVoltage(void) final {
+    return (float)readBusVoltageRaw() * _busVoltageLsb_V();
+  }
+
+  /*!
+   *    @brief  Reads the shunt voltage in the ADC range now in use
+   *    @return The current shunt voltage measurement in mV
+   */
+  float readShuntVoltage(void) final {
+    // the CONFIG read for the range is part of the shunt voltage read
+    INA2XX_STATS_SCOPE(INA2XX_OP_SHUNT_VOLTAGE);
+    return (float)readShuntVoltageRaw() * _shuntVoltageLsb_mV(getADCRange());
+  }
+
+  /*!
+   *    @brief  Reads the current
+   *    @return The current current measurement in mA
+   */
+  float readCurrent(void) final {
+    return (float)readCurrentRaw() * _current_lsb * 1e3f;
+  }
+
+  /*!
+   *    @brief  Reads the power
+   *    @return The current power calculation in mW
+   */
+  float readPower(void) final {
+    return (float)readPowerRaw() * ChipTraits::powerLsbFactor() *
+           _current_lsb * 1e3f;
+  }
+
+  /*!
+   *    @brief  Sets the shunt calibration by resistor
+   *    @param  shunt_res
+   *            Resistance of the shunt in ohms
+   *    @param  max_current
+   *            Maximum expected current in A
+   *    @return True if SHUNT_CAL was written and fits its field, false if
+   *            the write failed or the value had to be clamped
+   */
+  bool setShunt(float shunt_res = 0.1, float max_current = 3.2) override {
+    INA2XX_STATS_SCOPE(INA2XX_OP_CONFIG);
+    _setShuntScales(shunt_res, max_current);
+    return _updateShuntCalRegister();
+  }
+
+  /*!
+   *    @brief  Sets the current above which SHNTOL trips. The limit is
+   *            kept and rewritten when setShunt(), setADCRange() or the
+   *            calibration change the scaling.
+   *    @param  amps
+   *            Current limit in A
+   *    @return True if written and inside the register range, false if
+   *            the write failed or the limit had to be clamped
+   */
+  bool setOvercurrentLimit(float amps) {
+    _overcurrent_limit = amps;
+    _limits_set |= INA2XX_LIMIT_SHUNT_OVER;
+    return _writeShuntLimit(INA2XX_REG_SOVL, amps, getADCRange());
+  }
+
+  /*!
+   *    @brief  Reads the overcurrent limit back from SOVL
+   *    @return Current limit in A
+   */
+  float getOvercurrentLimit(void) {
+    return (int16_t)_readRegisterBits(INA2XX_REG_SOVL, 16, 0) *
+           _shuntLimitLsb_V(getADCRange()) / _shunt_res;
+  }
+
+  /*!
+   *    @brief  Sets the current below which SHNTUL trips. Kept and
+   *            rewritten on scaling changes like setOvercurrentLimit().
+   *    @param  amps
+   *            Current limit in A, negative for reverse current
+   *    @return True if written and inside the register range, false if
+   *            the write failed or the limit had to be clamped
+   */
+  bool setUndercurrentLimit(float amps) {
+    _undercurrent_limit = amps;
+    _limits_set |= INA2XX_LIMIT_SHUNT_UNDER;
+    return _writeShuntLimit(INA2XX_REG_SUVL, amps, getADCRange());
+  }
+
+  /*!
+   *    @brief  Reads the undercurrent limit back from SUVL
+   *    @return Current limit in A
+   */
+  float getUndercurrentLimit(void) {
+    return (int16_t)_readRegisterBits(INA2XX_REG_SUVL, 16, 0) *
+           _shuntLimitLsb_V(getADCRange()) / _shunt_res;
+  }
+
+  /*!
+   *    @brief  Sets the bus voltage above which BUSOL trips
+   *    @param  volts
+   *            Voltage limit in V
+   *    @return True if written and inside the register range, false if
+   *            the write failed or the limit had to be clamped
+   */
+  bool setBusOvervoltageLimit(float volts) {
+    return _writeLimit(INA2XX_REG_BOVL, volts / _busLimitLsb_V(), 0,
+                       ChipTraits::bus_limit_max);
+  }
+
+  /*!
+   *    @brief  Reads the bus overvoltage limit back from BOVL
+   *    @return Voltage limit in V
+   */
+  float getBusOvervoltageLimit(void) {
+    return _readRegisterBits(INA2XX_REG_BOVL, 15, 0) * _busLimitLsb_V();
+  }
+
+  /*!
+   *    @brief  Sets the bus voltage below which BUSUL trips
+   *    @param  volts
+   *            Voltage limit in V
+   *    @return True if written and inside the register range, false if
+   *            the write failed or the limit had to be clamped
+   */
+  bool setBusUndervoltageLimit(float volts) {
+    return _writeLimit(INA2XX_REG_BUVL, volts / _busLimitLsb_V(), 0,
+                       ChipTraits::bus_limit_max);
+  }
+
+  /*!
+   *    @brief  Reads the bus undervoltage limit back from BUVL
+   *    @return Voltage limit in V
+   */
+  float getBusUndervoltageLimit(void) {
+    return _readRegisterBits(INA2XX_REG_BUVL, 15, 0) * _busLimitLsb_V();
+  }
+
+  /*!
+   *    @brief  Sets the die temperature above which TMPOL trips
+   *    @param  celsius
+   *            Temperature limit in deg C
+   *    @return True if written and inside the register range, false if
+   *            the write failed or the limit had to be clamped
+   */
+  bool setTemperatureLimit(float celsius) {
+    return _writeLimit(INA2XX_REG_TEMPLIMIT, celsius / _tempLimitLsb_C(),
+                       -32768L, 32767L);
+  }
+
+  /*!
+   *    @brief  Reads the temperature limit back from TEMP_LIMIT
+   *    @return Temperature limit in deg C
+   */
+  float getTemperatureLimit(void) {
+    return (int16_t)_readRegisterBits(INA2XX_REG_TEMPLIMIT, 16, 0) *
+           _tempLimitLsb_C();
+  }
+
+  /*!
+   *    @brief  Sets the power above which POL trips. Kept and rewritten on
+   *            scaling changes like setOvercurrentLimit().
+   *    @param  watts
+   *            Power limit in W
+   *    @return True if written and inside the register range, false if
+   *            the write failed or the limit had to be clamped
+   */
+  bool setPowerLimit(float watts) {
+    _power_limit = watts;
+    _limits_set |= INA2XX_LIMIT_POWER_OVER;
+    return _writePowerLimit(watts);
+  }
+
+  /*!
+   *    @brief  Reads the power limit back from PWR_LIMIT
+   *    @return Power limit in W
+   */
+  float getPowerLimit(void) {
+    return _readRegisterBits(INA2XX_REG_PWRLIMIT, 16, 0) * _powerLimitLsb_W();
+  }
+
+  /*!
+   *    @brief  Puts every limit register back to its power-on value, which
+   *            never trips
+   *    @return True if all registers were written
+   */
+  bool clearLimits(void) {
+    _limits_set = 0;
+    return _writeRegister(INA2XX_REG_SOVL, 0x7FFF) &&
+           _writeRegister(INA2XX_REG_SUVL, 0x8000) &&
+           _writeRegister(INA2XX_REG_BOVL, ChipTraits::bus_limit_max) &&
+           _writeRegister(INA2XX_REG_BUVL, 0) &&
+           _writeRegister(INA2XX_REG_TEMPLIMIT, 0x7FFF) &&
+           _writeRegister(INA2XX_REG_PWRLIMIT, 0xFFFF);
+  }
+
+  /*!
+   *    @brief  Reads the shunt voltage using integer math only
+   *    @return The current shunt voltage measurement in nV
+   */
+  int32_t readShuntVoltage_nV(void) {
+    int32_t nV = readShuntVoltageRaw() * (int32_t)ChipTraits::shunt_lsb_nV;
+    if (getADCRange()) {
+      return nV / (1L << ChipTraits::shunt_lsb_shift_range1);
+    }
+    return nV / (1L << ChipTraits::shunt_lsb_shift);
+  }
+
+  /*!
+   *    @brief  Reads the bus voltage using integer math only
+   *    @return The current bus voltage measurement in uV
+   */
+  int32_t readBusVoltage_uV(void) {
+    return (readBusVoltageRaw() * (uint32_t)ChipTraits::bus_lsb_uV) >>
+           ChipTraits::bus_lsb_shift;
+  }
+
+  /*!
+   *    @brief  Reads the die temperature using integer math only
+   *    @return The current die temp in milli-degrees C
+   */
+  int32_t readDieTemp_mC(void) {
+    return (int32_t)readDieTempRaw() * (int32_t)ChipTraits::temp_lsb_mC /
+           (1L << ChipTraits::temp_lsb_shift);
+  }
+
+ protected:
+  /*!
+   *    @brief  Writes SHUNT_CAL for the current shunt and ADC range
+   *    @return True if written and the value fits its field
+   */
+  bool _updateShuntCalRegister(void) final {
+    uint8_t range = getADCRange();
+    bool ok = _writeRegister(INA2XX_REG_SHUNTCAL, _shuntCalFor(range)) &&
+              _shuntCalFits(range);
+    _updateLimitRegisters(range);
+    return ok;
+  }
+
+  /*!
+   *    @brief  Rewrites the current and power limits that were set, after
+   *            the shunt, current LSB or ADC range changed
+   *    @param  range
+   *            The ADC range now in use, 0 or 1
+   *    @return True if all of them were written and fit their registers
+   */
+  bool _updateLimitRegisters(uint8_t range) {
+    bool ok = true;
+    if (_limits_set & INA2XX_LIMIT_SHUNT_OVER) {
+      ok &= _writeShuntLimit(INA2XX_REG_SOVL, _overcurrent_limit, range);
+    }
+    if (_limits_set & INA2XX_LIMIT_SHUNT_UNDER) {
+      ok &= _writeShuntLimit(INA2XX_REG_SUVL, _undercurrent_limit, range);
+    }
+    if (_limits_set & INA2XX_LIMIT_POWER_OVER) {
+      ok &= _writePowerLimit(_power_limit);
+    }
+    return ok;
+  }
+
+  /*!
+   *    @brief  Writes a current limit to SOVL or SUVL
+   *    @param  reg
+   *            INA2XX_REG_SOVL or INA2XX_REG_SUVL
+   *    @param  amps
+   *            Current limit in A
+   *    @param  range
+   *            The ADC range, 0 or 1
+   *    @return True if written and inside the register range
+   */
+  bool _writeShuntLimit(uint8_t reg, float amps, uint8_t range) {
+    return _writeLimit(reg, amps * _shunt_res / _shuntLimitLsb_V(range),
+                       -32768L, 32767L);
+  }
+
+  /*!
+   *    @brief  Writes a power limit to PWR_LIMIT
+   *    @param  watts
+   *            Power limit in W
+   *    @return True if written and inside the register range
+   */
+  bool _writePowerLimit(float watts) {
+    return _writeLimit(INA2XX_REG_PWRLIMIT, watts / _powerLimitLsb_W(), 0,
+                       0xFFFF);
+  }
+
+  /*!
+   *    @brief  Rounds a limit to the nearest register value, clamps it and
+   *            writes it
+   *    @param  reg
+   *            The limit register
+   *    @param  counts
+   *            The limit in register LSBs
+   *    @param  min
+   *            Smallest register value
+   *    @param  max
+   *            Largest register value
+   *    @return True if written and counts was inside min..max
+   */
+  bool _writeLimit(uint8_t reg, float counts, int32_t min, int32_t max) {
+    int32_t value;
+    bool in_range = true;
+    if (counts < min) {
+      value = min;
+      in_range = false;
+    } else if (counts > max) {
+      value = max;
+      in_range = false;
+    } else {
+      value = (int32_t)(counts + (counts < 0 ? -0.5f : 0.5f));
+    }
+    return _writeRegister(reg, (uint16_t)value) && in_range;
+  }
+
+  /*!
+   *    @brief  SOVL/SUVL LSB
+   *    @param  range
+   *            The ADC range, 0 or 1
+   *    @return V per limit LSB
+   */
+  static constexpr float _shuntLimitLsb_V(uint8_t range) {
+    return _shuntVoltageLsb_mV(range) * (1UL << ChipTraits::limit_shift) /
+           1e3f;
+  }
+
+  /*!
+   *    @brief  BOVL/BUVL LSB
+   *    @return V per limit LSB
+   */
+  static constexpr float _busLimitLsb_V(void) {
+    return _busVoltageLsb_V() * (1UL << ChipTraits::limit_shift);
+  }
+
+  /*!
+   *    @brief  TEMP_LIMIT LSB
+   *    @return deg C per limit LSB
+   */
+  static constexpr float _tempLimitLsb_C(void) {
+    return _dieTempLsb_C() * (1UL << ChipTraits::temp_limit_shift);
+  }
+
+  /*!
+   *    @brief  PWR_LIMIT LSB, which follows the current LSB
+   *    @return W per limit LSB
+   */
+  float _powerLimitLsb_W(void) {
+    return ChipTraits::powerLsbFactor() * _current_lsb *
+           (1UL << ChipTraits::power_limit_shift);
+  }
+
+  /*!
+   *    @brief  Sets the current LSB and the current and power scales,
+   *            without touching the chip
+   *    @param  shunt_res
+   *            Resistance of the shunt in ohms
+   *    @param  max_current
+   *            Maximum expected current in A
+   */
+  void _setShuntScales(float shunt_res, float max_current) {
+    _shunt_res = shunt_res;
+    _current_lsb = max_current / (float)(1UL << ChipTraits::current_lsb_bits);
+    _current_scale = _makeScale(_current_lsb * 1e6);
+    _power_scale =
+        _makeScale(ChipTraits::powerLsbFactor() * _current_lsb * 1e6);
+  }
+
+  /*!
+   *    @brief  Works out SHUNT_CAL for the current shunt scales
+   *    @param  range
+   *            The ADC range, 0 or 1
+   *    @return The SHUNT_CAL register value, rounded and clamped
+   */
+  uint16_t _shuntCalFor(uint8_t range) {
+    return ChipTraits::shuntCalRegister(
+        ChipTraits::shuntCal(_shunt_res, _current_lsb, range));
+  }
+
+  /*!
+   *    @brief  Checks that SHUNT_CAL for the current shunt scales fits its
+   *            field without clamping
+   *    @param  range
+   *            The ADC range, 0 or 1
+   *    @return True if it does
+   */
+  bool _shuntCalFits(uint8_t range) {
+    return ChipTraits::shuntCalFits(
+        ChipTraits::shuntCal(_shunt_res, _current_lsb, range));
+  }
+
+  /*!
+   *    @brief  Shunt voltage LSB
+   *    @param  range
+   *            The ADC range, 0 or 1
+   *    @return mV per VSHUNT LSB
+   */
+  static constexpr float _shuntVoltageLsb_mV(uint8_t range) {
+    return (float)ChipTraits::shunt_lsb_nV /
+           (float)(1UL << (range ? ChipTraits::shunt_lsb_shift_range1
+                                 : ChipTraits::shunt_lsb_shift)) /
+           1e6f;
+  }
+
+  /*!
+   *    @brief  Bus voltage LSB
+   *    @return V per VBUS LSB
+   */
+  static constexpr float _busVoltageLsb_V(void) {
+    return (float)ChipTraits::bus_lsb_uV /
+           (float)(1UL << ChipTraits::bus_lsb_shift) / 1e6f;
+  }
+
+  /*!
+   *    @brief  Die temperature LSB
+   *    @return deg C per DIETEMP LSB
+   */
+  static constexpr float _dieTempLsb_C(void) {
+    return (float)ChipTraits::temp_lsb_mC /
+           (float)(1UL << ChipTraits::temp_lsb_shift) / 1e3f;
+  }
+
+  float _overcurrent_limit;  ///< Last setOvercurrentLimit() in A
+  float _undercurrent_limit; ///< Last setUndercurrentLimit() in A
+  float _power_limit;        ///< Last setPowerLimit() in W
+  uint8_t _limits_set;       ///< INA2XX_LimitEvent bits of the limits above
+};
+
+#endif
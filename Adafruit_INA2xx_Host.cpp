@@ -0,0 +1,134 @@
+/*!
+ *  @file Adafruit_INA2xx_Host.cpp
+ *
+ * 	Board functions for building the INA2xx driver on a host, such as
+ *  Linux with INA2xx_LinuxTransport or a test run against the simulator.
+ *  Compiles to nothing on Arduino targets.
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_INA2xx_Platform.h"
+
+#if !defined(ARDUINO)
+
+#include <time.h>
+
+static INA2xx_HostMicros host_micros = NULL; ///< Clock override, if any
+static INA2xx_HostDelay host_delay = NULL;   ///< Delay override, if any
+
+/**************************************************************************/
+/*!
+    @brief Gets the time, wrapping like the Arduino micros()
+    @return Time in us from the monotonic clock or the clock override
+*/
+/**************************************************************************/
+uint32_t micros(void) {
+  if (host_micros) {
+    return host_micros();
+  }
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+/**************************************************************************/
+/*!
+    @brief Waits, with the delay override if one is set
+    @param us
+          Time to wait in us
+*/
+/**************************************************************************/
+void delayMicroseconds(unsigned int us) {
+  if (host_delay) {
+    host_delay(us);
+    return;
+  }
+  struct timespec wait;
+  wait.tv_sec = us / 1000000;
+  wait.tv_nsec = (long)(us % 1000000) * 1000;
+  nanosleep(&wait, NULL);
+}
+
+/**************************************************************************/
+/*!
+    @brief Does nothing, a host has no pins
+    @param pin
+          Ignored
+    @param mode
+          Ignored
+*/
+/**************************************************************************/
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads a pin. A host has none, so an ALERT pin given with
+    setAlertPin() never shows a conversion and the driver polls the bus.
+    @param pin
+          Ignored
+    @return HIGH, the idle level of ALERT
+*/
+/**************************************************************************/
+int digitalRead(uint8_t pin) {
+  (void)pin;
+  return HIGH;
+}
+
+/**************************************************************************/
+/*!
+    @brief Does nothing, a host has no pin interrupts. Code that attached
+    one, like INA228_Acquisition, is driven by calling its handler instead.
+    @param interrupt
+          Ignored
+    @param handler
+          Ignored, never called
+    @param mode
+          Ignored
+*/
+/**************************************************************************/
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) {
+  (void)interrupt;
+  (void)handler;
+  (void)mode;
+}
+
+/**************************************************************************/
+/*!
+    @brief Does nothing, a host has no pin interrupts
+    @param interrupt
+          Ignored
+*/
+/**************************************************************************/
+void detachInterrupt(uint8_t interrupt) {
+  (void)interrupt;
+}
+
+/**************************************************************************/
+/*!
+    @brief Replaces the clock the driver times conversions with. Tests pass
+    the simulator's clock, so a conversion that takes a second on the chip
+    is waited for without sleeping.
+    @param now
+          Returns the time in us, NULL for the monotonic clock
+    @param wait
+          Moves the time on by the given us, NULL to sleep
+*/
+/**************************************************************************/
+void INA2xx_setHostClock(INA2xx_HostMicros now, INA2xx_HostDelay wait) {
+  host_micros = now;
+  host_delay = wait;
+}
+
+#endif // !ARDUINO
@@ -0,0 +1,208 @@
+/*!
+ *  @file Adafruit_INA2xx_LinuxTransport.cpp
+ *
+ * 	INA2xx transport over the Linux i2c-dev interface. Compiles to
+ *  nothing on other platforms.
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_INA2xx_LinuxTransport.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/*!
+ *    @brief  Binds the transport to a device, without opening the adapter
+ *    @param  device
+ *            Path of the adapter, such as "/dev/i2c-1". Not copied, so it
+ *            has to stay valid.
+ *    @param  i2c_addr
+ *            The I2C address of the device
+ */
+INA2xx_LinuxTransport::INA2xx_LinuxTransport(const char* device,
+                                             uint8_t i2c_addr)
+    : _device(device), _fd(-1), _address(i2c_addr), _syscalls(0) {}
+
+/*!
+ *    @brief  Closes the adapter
+ */
+INA2xx_LinuxTransport::~INA2xx_LinuxTransport() {
+  end();
+}
+
+/**************************************************************************/
+/*!
+    @brief Opens the adapter and checks that it can do combined transfers.
+    Whether the device answers is left to the first register read.
+    @return True if the adapter was opened and supports I2C_RDWR
+*/
+/**************************************************************************/
+bool INA2xx_LinuxTransport::begin(void) {
+  end();
+  _fd = open(_device, O_RDWR);
+  if (_fd < 0) {
+    return false;
+  }
+  unsigned long funcs = 0;
+  _syscalls++;
+  if (ioctl(_fd, I2C_FUNCS, &funcs) < 0 || !(funcs & I2C_FUNC_I2C)) {
+    end();
+    return false;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Closes the adapter. begin() opens it again.
+*/
+/**************************************************************************/
+void INA2xx_LinuxTransport::end(void) {
+  if (_fd >= 0) {
+    close(_fd);
+    _fd = -1;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Writes bytes in one transfer
+    @param buffer
+          Bytes to send
+    @param len
+          Number of bytes
+    @return True if the device acknowledged them
+*/
+/**************************************************************************/
+bool INA2xx_LinuxTransport::write(const uint8_t* buffer, size_t len) {
+  struct i2c_msg msg;
+  msg.addr = _address;
+  msg.flags = 0;
+  msg.len = len;
+  msg.buf = (uint8_t*)buffer;
+  return _transfer(&msg, 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief Writes bytes, then reads with a repeated start, in one ioctl
+    @param write_buffer
+          Bytes to send
+    @param write_len
+          Number of bytes to send
+    @param read_buffer
+          Receives the bytes read
+    @param read_len
+          Number of bytes to read
+    @return True if the transfer succeeded
+*/
+/**************************************************************************/
+bool INA2xx_LinuxTransport::writeThenRead(const uint8_t* write_buffer,
+                                          size_t write_len,
+                                          uint8_t* read_buffer,
+                                          size_t read_len) {
+  struct i2c_msg msgs[2];
+  msgs[0].addr = _address;
+  msgs[0].flags = 0;
+  msgs[0].len = write_len;
+  msgs[0].buf = (uint8_t*)write_buffer;
+  msgs[1].addr = _address;
+  msgs[1].flags = I2C_M_RD;
+  msgs[1].len = read_len;
+  msgs[1].buf = read_buffer;
+  return _transfer(msgs, 2);
+}
+
+/**************************************************************************/
+/*!
+    @brief Reads several registers with one ioctl per INA2XX_LINUX_MAX_BATCH
+    registers. The pointer writes and reads are chained with repeated
+    starts.
+    @param reads
+          The registers to read
+    @param count
+          Number of entries in reads
+    @return True if every read succeeded
+*/
+/**************************************************************************/
+bool INA2xx_LinuxTransport::readRegisters(INA2xx_RegisterRead* reads,
+                                          uint8_t count) {
+  struct i2c_msg msgs[2 * INA2XX_LINUX_MAX_BATCH];
+  while (count) {
+    uint8_t batch = count < INA2XX_LINUX_MAX_BATCH ? count
+                                                   : INA2XX_LINUX_MAX_BATCH;
+    for (uint8_t i = 0; i < batch; i++) {
+      msgs[2 * i].addr = _address;
+      msgs[2 * i].flags = 0;
+      msgs[2 * i].len = 1;
+      msgs[2 * i].buf = &reads[i].reg;
+      msgs[2 * i + 1].addr = _address;
+      msgs[2 * i + 1].flags = I2C_M_RD;
+      msgs[2 * i + 1].len = reads[i].len;
+      msgs[2 * i + 1].buf = reads[i].buffer;
+    }
+    if (!_transfer(msgs, 2 * batch)) {
+      return false;
+    }
+    reads += batch;
+    count -= batch;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Gets the device address
+    @return The 7-bit I2C address
+*/
+/**************************************************************************/
+uint8_t INA2xx_LinuxTransport::address(void) const {
+  return _address;
+}
+
+/**************************************************************************/
+/*!
+    @brief Counts the ioctl calls made, to compare batching choices
+    @return Number of ioctl calls since construction
+*/
+/**************************************************************************/
+uint32_t INA2xx_LinuxTransport::syscalls(void) const {
+  return _syscalls;
+}
+
+/**************************************************************************/
+/*!
+    @brief Runs messages as one combined I2C_RDWR transfer
+    @param messages
+          Array of struct i2c_msg
+    @param count
+          Number of messages
+    @return True if the kernel ran all of them
+*/
+/**************************************************************************/
+bool INA2xx_LinuxTransport::_transfer(void* messages, uint32_t count) {
+  if (_fd < 0) {
+    return false;
+  }
+  struct i2c_rdwr_ioctl_data data;
+  data.msgs = (struct i2c_msg*)messages;
+  data.nmsgs = count;
+  _syscalls++;
+  return ioctl(_fd, I2C_RDWR, &data) == (int)count;
+}
+
+#endif // __linux__
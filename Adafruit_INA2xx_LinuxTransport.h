@@ -0,0 +1,61 @@
+/*!
+ *  @file Adafruit_INA2xx_LinuxTransport.h
+ *
+ * 	INA2xx transport over the Linux i2c-dev interface
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA2XX_LINUXTRANSPORT_H
+#define _ADAFRUIT_INA2XX_LINUXTRANSPORT_H
+
+#if defined(__linux__)
+
+#include "Adafruit_INA2xx_Transport.h"
+
+/// Register reads per I2C_RDWR call, two messages each. The kernel takes at
+/// most I2C_RDWR_IOCTL_MAX_MSGS (42) messages per call.
+#define INA2XX_LINUX_MAX_BATCH 21
+
+/*!
+ *    @brief  Transport over /dev/i2c-N. Every transaction is a single
+ *            I2C_RDWR ioctl: a register read sends the pointer write and
+ *            the data read as one combined transfer with a repeated start,
+ *            and readRegisters() puts up to INA2XX_LINUX_MAX_BATCH register
+ *            reads into the same syscall.
+ */
+class INA2xx_LinuxTransport : public INA2xx_Transport {
+ public:
+  INA2xx_LinuxTransport(const char* device, uint8_t i2c_addr = 0x40);
+  ~INA2xx_LinuxTransport();
+
+  bool begin(void) override;
+  void end(void);
+  bool write(const uint8_t* buffer, size_t len) override;
+  bool writeThenRead(const uint8_t* write_buffer, size_t write_len,
+                     uint8_t* read_buffer, size_t read_len) override;
+  bool readRegisters(INA2xx_RegisterRead* reads, uint8_t count) override;
+
+  uint8_t address(void) const;
+  uint32_t syscalls(void) const;
+
+ private:
+  bool _transfer(void* messages, uint32_t count);
+
+  const char* _device; ///< Path of the adapter, such as "/dev/i2c-1"
+  int _fd;             ///< Open adapter, -1 if closed
+  uint8_t _address;    ///< 7-bit I2C address
+  uint32_t _syscalls;  ///< ioctl calls made
+};
+
+#endif // __linux__
+
+#endif
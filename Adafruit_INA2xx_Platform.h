@@ -0,0 +1,55 @@
+/*!
+ *  @file Adafruit_INA2xx_Platform.h
+ *
+ * 	The few board functions the INA2xx driver needs. Arduino targets get
+ *  them from the core, host builds from Adafruit_INA2xx_Host.cpp.
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA2XX_PLATFORM_H
+#define _ADAFRUIT_INA2XX_PLATFORM_H
+
+#if defined(ARDUINO)
+
+#include "Arduino.h"
+
+#else
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOW 0x0          ///< Pin level, as on Arduino
+#define HIGH 0x1         ///< Pin level, as on Arduino
+#define INPUT 0x0        ///< Pin mode, as on Arduino
+#define INPUT_PULLUP 0x2 ///< Pin mode, as on Arduino
+#define FALLING 0x2      ///< Interrupt mode, as on Arduino
+#define RISING 0x3       ///< Interrupt mode, as on Arduino
+
+/// A host has no pin interrupts, so every pin maps to its own number
+#define digitalPinToInterrupt(pin) (pin)
+
+/// Returns the time in us, for INA2xx_setHostClock()
+typedef uint32_t (*INA2xx_HostMicros)(void);
+/// Lets the given number of us pass, for INA2xx_setHostClock()
+typedef void (*INA2xx_HostDelay)(uint32_t us);
+
+uint32_t micros(void);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+void INA2xx_setHostClock(INA2xx_HostMicros now, INA2xx_HostDelay wait);
+
+#endif // ARDUINO
+
+#endif
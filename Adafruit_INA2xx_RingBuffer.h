@@ -0,0 +1,122 @@
+/*!
+ *  @file Adafruit_INA2xx_RingBuffer.h
+ *
+ * 	Fixed capacity single-producer/single-consumer ring buffer
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA2XX_RINGBUFFER_H
+#define _ADAFRUIT_INA2XX_RINGBUFFER_H
+
+#include <stdint.h>
+
+#if defined(__AVR__)
+// single core, stopping the compiler from reordering is enough
+#define INA2XX_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define INA2XX_MEMORY_BARRIER() __sync_synchronize() ///< Full memory barrier
+#endif
+
+/*!
+ *    @brief  Lock-free ring buffer for one producer (for example an
+ *            interrupt handler) and one consumer.
+ *
+ *    The indices are free-running 8-bit counters, which are updated
+ *    atomically on every supported architecture. CAPACITY must be a power
+ *    of two no larger than 128.
+ */
+template <typename T, uint8_t CAPACITY>
+class INA2xx_RingBuffer {
+  static_assert(CAPACITY > 0 && CAPACITY <= 128 &&
+                    (CAPACITY & (CAPACITY - 1)) == 0,
+                "CAPACITY must be a power of two up to 128");
+
+ public:
+  /*!
+   *    @brief  Instantiates an empty ring buffer
+   */
+  INA2xx_RingBuffer() : _head(0), _tail(0) {}
+
+  /*!
+   *    @brief  Adds an item. Only call from the producer.
+   *    @param  item
+   *            The item to copy into the buffer
+   *    @return False if the buffer was full and the item was dropped
+   */
+  bool push(const T& item) {
+    uint8_t head = _head;
+    if ((uint8_t)(head - _tail) >= CAPACITY) {
+      return false;
+    }
+    _items[head & (CAPACITY - 1)] = item;
+    INA2XX_MEMORY_BARRIER(); // publish the item before the index
+    _head = head + 1;
+    return true;
+  }
+
+  /*!
+   *    @brief  Removes the oldest item. Only call from the consumer.
+   *    @param  item
+   *            Set to the removed item
+   *    @return False if the buffer was empty
+   */
+  bool pop(T& item) {
+    uint8_t tail = _tail;
+    if (tail == _head) {
+      return false;
+    }
+    INA2XX_MEMORY_BARRIER(); // read the index before the item
+    item = _items[tail & (CAPACITY - 1)];
+    INA2XX_MEMORY_BARRIER(); // finish the copy before freeing the slot
+    _tail = tail + 1;
+    return true;
+  }
+
+  /*!
+   *    @brief  Removes up to max items at once. Only call from the consumer.
+   *    @param  items
+   *            Array to receive the items, oldest first
+   *    @param  max
+   *            Size of the array
+   *    @return Number of items removed
+   */
+  uint8_t pop(T* items, uint8_t max) {
+    uint8_t count = 0;
+    while (count < max && pop(items[count])) {
+      count++;
+    }
+    return count;
+  }
+
+  /*!
+   *    @brief  Returns the number of items waiting
+   *    @return Items that can be popped
+   */
+  uint8_t available(void) const {
+    return (uint8_t)(_head - _tail);
+  }
+
+  /*!
+   *    @brief  Returns the capacity
+   *    @return Maximum number of items held at once
+   */
+  uint8_t capacity(void) const {
+    return CAPACITY;
+  }
+
+ private:
+  T _items[CAPACITY];      ///< Item storage
+  volatile uint8_t _head;  ///< Count of items pushed, owned by the producer
+  volatile uint8_t _tail;  ///< Count of items popped, owned by the consumer
+};
+
+#endif
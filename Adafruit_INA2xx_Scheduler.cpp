@@ -0,0 +1,157 @@
+/*!
+ *  @file Adafruit_INA2xx_Scheduler.cpp
+ *
+ * 	Queues asynchronous INA2xx transfers from one or more sensors
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#include "Adafruit_INA2xx_Scheduler.h"
+
+/*!
+ *    @brief  Instantiates an empty scheduler
+ *    @param  max_in_flight
+ *            Most transfers running at once, at least 1
+ */
+INA2xx_FifoScheduler::INA2xx_FifoScheduler(uint8_t max_in_flight)
+    : _queue_head(NULL),
+      _queue_tail(NULL),
+      _running(NULL),
+      _max_in_flight(max_in_flight ? max_in_flight : 1),
+      _in_flight(0),
+      _starting(false) {}
+
+/**************************************************************************/
+/*!
+    @brief Queues a transfer and starts it if a slot is free
+    @param transfer
+          The transfer. May be submitted again from its own done callback.
+    @return True if the transfer was accepted, false if it is incomplete
+    or still pending
+*/
+/**************************************************************************/
+bool INA2xx_FifoScheduler::submit(INA2xx_Transfer* transfer) {
+  if (!transfer || !transfer->transport || !transfer->done ||
+      transfer->pending) {
+    return false;
+  }
+  // a transfer resubmitted from its callback may still be linked as running
+  _reap();
+  transfer->pending = true;
+  transfer->next = NULL;
+  if (_queue_tail) {
+    _queue_tail->next = transfer;
+  } else {
+    _queue_head = transfer;
+  }
+  _queue_tail = transfer;
+  _startQueued();
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief Polls the transports of running transfers, drops the finished
+    ones and starts as many queued transfers as there are free slots
+*/
+/**************************************************************************/
+void INA2xx_FifoScheduler::poll(void) {
+  // done callbacks may resubmit and relink, so fetch next before polling
+  INA2xx_Transfer* t = _running;
+  while (t) {
+    INA2xx_Transfer* next = t->next;
+    if (t->pending) {
+      t->transport->poll();
+    }
+    t = next;
+  }
+  _reap();
+  _startQueued();
+}
+
+/**************************************************************************/
+/*!
+    @brief Checks whether all submitted transfers have finished
+    @return True if nothing is queued or running
+*/
+/**************************************************************************/
+bool INA2xx_FifoScheduler::idle(void) {
+  _reap();
+  return !_queue_head && !_running;
+}
+
+/**************************************************************************/
+/*!
+    @brief Gets the number of running transfers
+    @return Transfers started whose done callback may not have run yet
+*/
+/**************************************************************************/
+uint8_t INA2xx_FifoScheduler::inFlight(void) const {
+  return _in_flight;
+}
+
+/**************************************************************************/
+/*!
+    @brief Removes the finished transfers from the running list
+*/
+/**************************************************************************/
+void INA2xx_FifoScheduler::_reap(void) {
+  INA2xx_Transfer** link = &_running;
+  while (*link) {
+    if ((*link)->pending) {
+      link = &(*link)->next;
+    } else {
+      *link = (*link)->next;
+      _in_flight--;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief Starts queued transfers in order while slots are free and the
+    transport of the next one is idle. A done callback that submits again
+    only queues, the outer call starts it.
+*/
+/**************************************************************************/
+void INA2xx_FifoScheduler::_startQueued(void) {
+  if (_starting) {
+    return;
+  }
+  _starting = true;
+  _reap();
+  // only start what is queued now, or a synchronous transport whose
+  // callback resubmits would keep this loop going forever
+  uint8_t budget = 0;
+  for (INA2xx_Transfer* q = _queue_head; q && budget < 255; q = q->next) {
+    budget++;
+  }
+  while (budget && _queue_head && _in_flight < _max_in_flight &&
+         !_queue_head->transport->busy()) {
+    budget--;
+    INA2xx_Transfer* t = _queue_head;
+    _queue_head = t->next;
+    if (!_queue_head) {
+      _queue_tail = NULL;
+    }
+    t->next = _running;
+    _running = t;
+    _in_flight++;
+    if (!t->transport->startTransfer(t)) {
+      // the transport turned it down, report the failure
+      t->ok = false;
+      t->pending = false;
+      t->done(t);
+    }
+    _reap();
+  }
+  _starting = false;
+}
@@ -0,0 +1,81 @@
+/*!
+ *  @file Adafruit_INA2xx_Scheduler.h
+ *
+ * 	Queues asynchronous INA2xx transfers from one or more sensors
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA2XX_SCHEDULER_H
+#define _ADAFRUIT_INA2XX_SCHEDULER_H
+
+#include "Adafruit_INA2xx_Transport.h"
+
+/*!
+ *    @brief  Decides when queued transfers are started. Drivers hand their
+ *            asynchronous reads to a scheduler set with setScheduler(), so
+ *            requests from several sensors can share the bus.
+ */
+class INA2xx_Scheduler {
+ public:
+  virtual ~INA2xx_Scheduler() {}
+
+  /*!
+   *    @brief  Queues a transfer. It may start before this returns.
+   *    @param  transfer
+   *            The transfer, not pending. The scheduler sets pending, and
+   *            the transfer must stay alive until its done callback ran.
+   *    @return True if the transfer was accepted
+   */
+  virtual bool submit(INA2xx_Transfer* transfer) = 0;
+
+  /*!
+   *    @brief  Polls running transfers and starts queued ones. Call it from
+   *            loop(); done callbacks of polled transports run from here.
+   */
+  virtual void poll(void) = 0;
+
+  /*!
+   *    @brief  Checks whether all submitted transfers have finished
+   *    @return True if nothing is queued or running
+   */
+  virtual bool idle(void) = 0;
+};
+
+/*!
+ *    @brief  Starts transfers in the order they were submitted, keeping up
+ *            to max_in_flight of them running. The next transfer starts as
+ *            soon as one finishes, so the bus stays busy while the CPU
+ *            decodes the last result. Raise max_in_flight only if the
+ *            transports sit on separate buses.
+ */
+class INA2xx_FifoScheduler : public INA2xx_Scheduler {
+ public:
+  INA2xx_FifoScheduler(uint8_t max_in_flight = 1);
+
+  bool submit(INA2xx_Transfer* transfer) override;
+  void poll(void) override;
+  bool idle(void) override;
+  uint8_t inFlight(void) const;
+
+ private:
+  void _reap(void);
+  void _startQueued(void);
+
+  INA2xx_Transfer* _queue_head; ///< Next transfer to start
+  INA2xx_Transfer* _queue_tail; ///< Last transfer submitted
+  INA2xx_Transfer* _running;    ///< Started transfers, linked by next
+  uint8_t _max_in_flight;       ///< Most transfers running at once
+  uint8_t _in_flight;           ///< Transfers in _running
+  bool _starting;               ///< Guards _startQueued against re-entry
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*!
+ *  @file Adafruit_INA2xx_Transport.h
+ *
+ * 	Bus interface the INA2xx driver talks through
+ *
+ * 	This is a library for the Adafruit INA228 breakout:
+ * 	http://www.adafruit.com/products/5832
+ *
+ * 	Adafruit invests time and resources providing this open source code,
+ *  please support Adafruit and open-source hardware by purchasing products from
+ * 	Adafruit!
+ *
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _ADAFRUIT_INA2XX_TRANSPORT_H
+#define _ADAFRUIT_INA2XX_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define INA2XX_I2C_STANDARD 100000UL   ///< Standard-mode SCL in Hz
+#define INA2XX_I2C_FAST 400000UL       ///< Fast-mode SCL in Hz
+#define INA2XX_I2C_FAST_PLUS 1000000UL ///< Fast-mode Plus SCL in Hz
+#define INA2XX_I2C_HS_MASTER_CODE 0x08 ///< Sent at Fast-mode to enter HS
+
+/// Highest High-speed SCL in Hz. Entering HS with the master code is only
+/// modelled by INA228_SimulatorTransport, the Arduino and Linux transports
+/// reject it.
+#define INA2XX_I2C_HIGH_SPEED 2940000UL
+
+/**
+ * @brief One register read of a batch passed to readRegisters.
+ */
+typedef struct {
+  uint8_t reg;     ///< Register address, sent as the pointer byte
+  uint8_t len;     ///< Register width in bytes
+  uint8_t* buffer; ///< Receives len bytes, MSB first
+} INA2xx_RegisterRead;
+
+struct INA2xx_Transfer;
+class INA2xx_Transport;
+
+/// Called once a transfer started with startTransfer has finished
+typedef void (*INA2xx_TransferCallback)(INA2xx_Transfer* transfer);
+
+/**
+ * @brief A batch of register reads run without blocking the caller.
+ *
+ * The caller owns the memory and keeps it alive until done is called.
+ * Whoever starts the transfer sets pending, the transport clears it right
+ * before calling done.
+ */
+typedef struct INA2xx_Transfer {
+  INA2xx_Transport* transport;  ///< Device to read from
+  INA2xx_RegisterRead* reads;   ///< Registers to read
+  uint8_t count;                ///< Number of entries in reads
+  INA2xx_TransferCallback done; ///< Called when the reads finished
+  void* context;                ///< Left alone, for the owner of done
+  volatile bool pending;        ///< True from start until done is called
+  bool ok;                      ///< True if every read succeeded
+  INA2xx_Transfer* next;        ///< Queue link used by a scheduler
+} INA2xx_Transfer;
+
+/*!
+ *    @brief  Moves bytes between the driver and one INA2xx. Plain C++ with
+ *            no Arduino dependencies, so backends and mocks build for
+ *            boards and hosts alike.
+ *
+ *    A transport is bound to one device address. Register reads are a
+ *    pointer write followed by a read, and should be done with a repeated
+ *    start so nothing else can move the pointer in between.
+ */
+class INA2xx_Transport {
+ public:
+  virtual ~INA2xx_Transport() {}
+
+  /*!
+   *    @brief  Gets the bus ready and checks that the device answers
+   *    @return True if the device was found
+   */
+  virtual bool begin(void) = 0;
+
+  /*!
+   *    @brief  Writes bytes in one transaction
+   *    @param  buffer
+   *            Bytes to send, the register pointer first
+   *    @param  len
+   *            Number of bytes
+   *    @return True if the device acknowledged them
+   */
+  virtual bool write(const uint8_t* buffer, size_t len) = 0;
+
+  /*!
+   *    @brief  Writes bytes, then reads with a repeated start
+   *    @param  write_buffer
+   *            Bytes to send, usually just the register pointer
+   *    @param  write_len
+   *            Number of bytes to send
+   *    @param  read_buffer
+   *            Receives the bytes read
+   *    @param  read_len
+   *            Number of bytes to read
+   *    @return True if the transaction succeeded
+   */
+  virtual bool writeThenRead(const uint8_t* write_buffer, size_t write_len,
+                             uint8_t* read_buffer, size_t read_len) = 0;
+
+  /*!
+   *    @brief  Reads several registers. Backends that can queue transfers
+   *            override this to do them in one go, the default reads them
+   *            one after the other.
+   *    @param  reads
+   *            The registers to read
+   *    @param  count
+   *            Number of entries in reads
+   *    @return True if every read succeeded
+   */
+  virtual bool readRegisters(INA2xx_RegisterRead* reads, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+      if (!writeThenRead(&reads[i].reg, 1, reads[i].buffer, reads[i].len)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*!
+   *    @brief  Starts a transfer and returns without waiting for it.
+   *            Transports driven by interrupts or DMA override this
+   *            together with busy() and poll(). The default runs the reads
+   *            right away and calls done before returning.
+   *    @param  transfer
+   *            The transfer, with pending set
+   *    @return True if the transfer was started, false if the transport
+   *            is busy. done is only called for a started transfer.
+   */
+  virtual bool startTransfer(INA2xx_Transfer* transfer) {
+    transfer->ok = readRegisters(transfer->reads, transfer->count);
+    transfer->pending = false;
+    transfer->done(transfer);
+    return true;
+  }
+
+  /*!
+   *    @brief  Checks whether a started transfer is still running
+   *    @return True if startTransfer() would refuse a new transfer
+   */
+  virtual bool busy(void) {
+    return false;
+  }
+
+  /*!
+   *    @brief  Changes the SCL frequency. Above INA2XX_I2C_FAST_PLUS the
+   *            transport has to enter High-speed mode by sending
+   *            INA2XX_I2C_HS_MASTER_CODE at Fast-mode speed, and chain
+   *            transactions with repeated starts since a stop leaves HS.
+   *    @param  clock_hz
+   *            The SCL frequency in Hz
+   *    @return True if the transport runs at that speed now. The default
+   *            can't change the clock and returns false.
+   */
+  virtual bool setClock(uint32_t clock_hz) {
+    (void)clock_hz;
+    return false;
+  }
+
+  /*!
+   *    @brief  Works out how long register reads keep the bus busy. Each
+   *            read is a start, the address and pointer byte, a repeated
+   *            start, the address again, the data bytes and a stop, with 9
+   *            clocks per byte. In High-speed mode the reads are chained
+   *            behind one master code sent at INA2XX_I2C_FAST.
+   *    @param  reads
+   *            The registers read
+   *    @param  count
+   *            Number of entries in reads
+   *    @param  clock_hz
+   *            The SCL frequency in Hz
+   *    @return Bus time in us, rounded up
+   */
+  static uint32_t readMicros(const INA2xx_RegisterRead* reads, uint8_t count,
+                             uint32_t clock_hz) {
+    uint32_t bits = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      bits += 3 + 9 * (3 + reads[i].len);
+    }
+    uint64_t ns = ((uint64_t)bits * 1000000000UL + clock_hz - 1) / clock_hz;
+    if (clock_hz > INA2XX_I2C_FAST_PLUS) {
+      // start plus the master code byte, which nobody acknowledges
+      ns += 10 * 1000000000ULL / INA2XX_I2C_FAST;
+    }
+    return (uint32_t)((ns + 999) / 1000);
+  }
+
+  /*!
+   *    @brief  Moves running transfers along and calls done for the ones
+   *            that finished. Transports that complete from an interrupt
+   *            can leave this empty.
+   */
+  virtual void poll(void) {}
+};
+
+#endif
@@ -0,0 +1,57 @@
+// Reads every conversion of the INA228 without polling, using the ALERT pin.
+// Wire ALERT to an interrupt capable pin and set ALERT_PIN to match.
+#include <Adafruit_INA228_Acquisition.h>
+
+#define ALERT_PIN 2
+
+Adafruit_INA228 ina228 = Adafruit_INA228();
+INA228_Acquisition acquisition(&ina228, INA228_CHANNEL_CURRENT |
+                                            INA228_CHANNEL_BUS_VOLTAGE);
+
+void setup() {
+  Serial.begin(115200);
+  // Wait until serial port is opened
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println("Adafruit INA228 ALERT acquisition");
+
+  if (!ina228.begin()) {
+    Serial.println("Couldn't find INA228 chip");
+    while (1)
+      ;
+  }
+  ina228.setShunt(0.015, 10.0);
+  // one conversion roughly every 65 ms
+  ina228.setAveragingCount(INA228_COUNT_64);
+
+  if (!acquisition.begin(ALERT_PIN)) {
+    Serial.println("Couldn't attach the ALERT interrupt");
+    while (1)
+      ;
+  }
+}
+
+void loop() {
+  acquisition.service();
+
+  INA228_Snapshot samples[4];
+  uint8_t count = acquisition.read(samples, 4);
+  for (uint8_t i = 0; i < count; i++) {
+    Serial.print(samples[i].timestamp_us);
+    Serial.print(" us: ");
+    Serial.print(samples[i].current_mA);
+    Serial.print(" mA, ");
+    Serial.print(samples[i].bus_voltage_V);
+    Serial.println(" V");
+  }
+
+  if (acquisition.missedConversions() || acquisition.overruns()) {
+    Serial.print("Missed: ");
+    Serial.print(acquisition.missedConversions());
+    Serial.print(" Overruns: ");
+    Serial.println(acquisition.overruns());
+    acquisition.clearCounters();
+  }
+}
@@ -0,0 +1,93 @@
+// Measures the time and CPU cycles per sample of the read functions, next
+// to the old way of building a BusIO register object for every read.
+#include <Adafruit_I2CRegister.h>
+#include <Adafruit_INA228.h>
+
+#define SAMPLES 1000
+
+Adafruit_INA228 ina228 = Adafruit_INA228();
+Adafruit_I2CDevice legacy_dev = Adafruit_I2CDevice(INA228_I2CADDR_DEFAULT);
+
+volatile int32_t sink; // keeps the compiler from dropping the reads
+
+// how each sample was read before the register access layer
+int32_t legacyReadCurrentRaw() {
+  Adafruit_I2CRegister current =
+      Adafruit_I2CRegister(&legacy_dev, INA2XX_REG_CURRENT, 3, MSBFIRST);
+  int32_t raw = current.read() >> 4;
+  if (raw & 0x80000)
+    raw |= 0xFFF00000;
+  return raw;
+}
+
+void report(const char* name, unsigned long elapsed_us) {
+  float us = (float)elapsed_us / SAMPLES;
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(us);
+  Serial.print(" us/sample");
+#ifdef F_CPU
+  Serial.print(", ");
+  Serial.print(us * (F_CPU / 1000000UL), 0);
+  Serial.print(" cycles/sample");
+#endif
+  Serial.println();
+}
+
+void setup() {
+  Serial.begin(115200);
+  // Wait until serial port is opened
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println("Adafruit INA228 read benchmark");
+
+  if (!ina228.begin() || !legacy_dev.begin()) {
+    Serial.println("Couldn't find INA228 chip");
+    while (1)
+      ;
+  }
+  ina228.setShunt(0.015, 10.0);
+  // serve configuration reads from memory, so only result reads hit the bus
+  ina228.enableRegisterCache();
+}
+
+void loop() {
+  unsigned long start;
+  INA228_Snapshot snapshot;
+
+  start = micros();
+  for (int i = 0; i < SAMPLES; i++) {
+    sink = legacyReadCurrentRaw();
+  }
+  report("Register object per read", micros() - start);
+
+  start = micros();
+  for (int i = 0; i < SAMPLES; i++) {
+    sink = ina228.readCurrentRaw();
+  }
+  report("readCurrentRaw()        ", micros() - start);
+
+  start = micros();
+  for (int i = 0; i < SAMPLES; i++) {
+    sink = ina228.readCurrent_uA();
+  }
+  report("readCurrent_uA()        ", micros() - start);
+
+  start = micros();
+  for (int i = 0; i < SAMPLES; i++) {
+    sink = ina228.readCurrent();
+  }
+  report("readCurrent()           ", micros() - start);
+
+  start = micros();
+  for (int i = 0; i < SAMPLES; i++) {
+    ina228.readSnapshot(snapshot, INA228_CHANNEL_CURRENT);
+    sink = snapshot.current_raw;
+  }
+  report("readSnapshot(CURRENT)   ", micros() - start);
+
+  Serial.println();
+  delay(2000);
+}
@@ -0,0 +1,37 @@
+// Streams readings to Serial in the packed binary log format. Capture the
+// port to a file and read it back with INA228_LogDecoder, which also builds
+// on a Linux host. Send 'h' to get a fresh header and keyframe.
+#include <Adafruit_INA228.h>
+#include <Adafruit_INA228_LogEncoder.h>
+
+Adafruit_INA228 ina228 = Adafruit_INA228();
+INA228_LogEncoder encoder = INA228_LogEncoder(INA228_CHANNEL_ALL, 64);
+
+void setup() {
+  Serial.begin(115200);
+  // Wait until serial port is opened
+  while (!Serial) {
+    delay(10);
+  }
+
+  if (!ina228.begin()) {
+    // no text on the port, a reader would take it for frames
+    while (1)
+      ;
+  }
+  ina228.setShunt(0.015, 10.0);
+  ina228.setAveragingCount(INA228_COUNT_16);
+  encoder.writeHeader(Serial, ina228);
+}
+
+void loop() {
+  if (Serial.available() && Serial.read() == 'h') {
+    encoder.writeHeader(Serial, ina228);
+  }
+
+  INA228_Snapshot snapshot;
+  if (ina228.conversionReady() &&
+      ina228.readSnapshot(snapshot, INA228_CHANNEL_ALL)) {
+    encoder.write(Serial, snapshot);
+  }
+}
@@ -0,0 +1,70 @@
+// Reports how many readings per second each I2C speed allows. The sensor
+// is simulated, and the bus time is modelled from the bytes on the wire,
+// so the numbers come out the same on any board or on a Linux host.
+#include <Adafruit_INA228.h>
+#include <Adafruit_INA228_Simulator.h>
+
+#define SAMPLES 1000
+
+INA228_Simulator simulator = INA228_Simulator();
+INA228_SimulatorTransport bus = INA228_SimulatorTransport(&simulator);
+Adafruit_INA228 ina228 = Adafruit_INA228();
+
+const uint32_t speeds[] = {INA2XX_I2C_STANDARD, INA2XX_I2C_FAST,
+                           INA2XX_I2C_FAST_PLUS, INA2XX_I2C_HIGH_SPEED};
+
+void report(const char* name, uint8_t channels) {
+  INA228_Snapshot snapshot;
+  uint32_t start = bus.busMicros();
+  for (int i = 0; i < SAMPLES; i++) {
+    ina228.readSnapshot(snapshot, channels);
+  }
+  uint32_t elapsed = bus.busMicros() - start;
+  Serial.print("  ");
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(SAMPLES * 1e6 / elapsed, 0);
+  Serial.print(" reads/s, achievable ");
+  Serial.print(ina228.achievableSampleRate(channels), 0);
+  Serial.println(" samples/s");
+}
+
+void setup() {
+  Serial.begin(115200);
+  // Wait until serial port is opened
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println("Adafruit INA228 bus speed benchmark");
+
+  if (!ina228.beginAsync(&bus)) {
+    Serial.println("Couldn't find INA228 chip");
+    while (1)
+      ;
+  }
+  ina228.setShunt(0.015, 10.0);
+  // fastest conversions, so the bus is what limits the sample rate
+  ina228.setCurrentConversionTime(INA228_TIME_50_us);
+  ina228.setVoltageConversionTime(INA228_TIME_50_us);
+  ina228.setTemperatureConversionTime(INA228_TIME_50_us);
+  ina228.setAveragingCount(INA228_COUNT_1);
+  // serve configuration reads from memory, so only result reads hit the bus
+  ina228.enableRegisterCache();
+}
+
+void loop() {
+  for (uint8_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+    if (!ina228.setBusClock(speeds[i])) {
+      continue;
+    }
+    Serial.print(speeds[i] / 1000);
+    Serial.println(" kHz:");
+    report("CURRENT  ", INA228_CHANNEL_CURRENT);
+    report("V, I, P  ", INA228_CHANNEL_BUS_VOLTAGE | INA228_CHANNEL_CURRENT |
+                            INA228_CHANNEL_POWER);
+    report("All      ", INA228_CHANNEL_ALL);
+  }
+  Serial.println();
+  delay(2000);
+}
@@ -0,0 +1,36 @@
+// Works out the shunt calibration at compile time. A shunt and current
+// pair that does not fit the INA228 stops the build with an error instead
+// of giving wrong readings.
+#include <Adafruit_INA228_Calibration.h>
+
+// 15 mOhm shunt, 10 A maximum current, shunt ADC range 0 (+/-163.84 mV)
+INA228_CALIBRATION(calibration, 0.015, 10.0, 0);
+
+Adafruit_INA228 ina228 = Adafruit_INA228();
+
+void setup() {
+  Serial.begin(115200);
+  // Wait until serial port is opened
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println("Adafruit INA228 compile-time calibration");
+
+  if (!ina228.begin(calibration)) {
+    Serial.println("Couldn't find INA228 chip");
+    while (1)
+      ;
+  }
+  Serial.print("SHUNT_CAL: ");
+  Serial.println(calibration.shunt_cal);
+}
+
+void loop() {
+  Serial.print("Current: ");
+  Serial.print(ina228.readCurrent_uA());
+  Serial.print(" uA, Power: ");
+  Serial.print((int32_t)(ina228.readPower_uW() / 1000));
+  Serial.println(" mW");
+  delay(1000);
+}
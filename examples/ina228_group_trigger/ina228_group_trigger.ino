@@ -0,0 +1,58 @@
+// Measures converter efficiency with one INA228 on the input rail and one
+// on the output rail, triggered together so both readings line up.
+#include <Adafruit_INA228_Group.h>
+
+Adafruit_INA228 input = Adafruit_INA228();
+Adafruit_INA228 output = Adafruit_INA228();
+INA228Group<2> group(INA228_CHANNEL_BUS_VOLTAGE | INA228_CHANNEL_CURRENT |
+                     INA228_CHANNEL_POWER);
+
+void setup() {
+  Serial.begin(115200);
+  // Wait until serial port is opened
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println("Adafruit INA228 group trigger");
+
+  if (!input.begin(0x40) || !output.begin(0x41)) {
+    Serial.println("Couldn't find both INA228 chips");
+    while (1)
+      ;
+  }
+  input.setShunt(0.015, 10.0);
+  output.setShunt(0.015, 10.0);
+  input.setAveragingCount(INA228_COUNT_16);
+  output.setAveragingCount(INA228_COUNT_16);
+
+  group.add(input);
+  group.add(output);
+  group.trigger();
+}
+
+void loop() {
+  switch (group.poll()) {
+  case INA2XX_CONVERSION_READY: {
+    const INA228_Snapshot* s = group.snapshots();
+    Serial.print("In: ");
+    Serial.print(s[0].power_mW);
+    Serial.print(" mW, Out: ");
+    Serial.print(s[1].power_mW);
+    Serial.print(" mW, Efficiency: ");
+    Serial.print(s[0].power_mW > 0 ? 100 * s[1].power_mW / s[0].power_mW : 0);
+    Serial.print(" %, Skew: ");
+    Serial.print(group.maxSkew());
+    Serial.println(" us");
+    delay(500);
+    group.trigger();
+    break;
+  }
+  case INA2XX_CONVERSION_TIMEOUT:
+    Serial.println("A conversion timed out");
+    group.trigger();
+    break;
+  default:
+    break;
+  }
+}
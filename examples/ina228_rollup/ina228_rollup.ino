@@ -0,0 +1,66 @@
+// Keeps a second, minute and hour history of current, power and energy,
+// and prints the slots of the last few minutes when 'h' is received.
+#include <Adafruit_INA228.h>
+#include <Adafruit_INA228_Rollup.h>
+
+Adafruit_INA228 ina228 = Adafruit_INA228();
+#if defined(__AVR__)
+INA228_Rollup<10, 10, 6> history; // about 1 kB
+#else
+INA228_Rollup<60, 60, 24> history; // about 5.3 kB
+#endif
+
+void printSlots(INA228_RollupTier tier, uint32_t from_s) {
+  INA228_RollupSlot slot;
+  // one slot at a time, so no buffer is needed
+  while (history.query(tier, from_s, history.now() + 1, &slot, 1)) {
+    Serial.print(slot.start_s);
+    Serial.print(" s: ");
+    Serial.print(slot.current_mean);
+    Serial.print(" mA (");
+    Serial.print(slot.current_min);
+    Serial.print(" - ");
+    Serial.print(slot.current_max);
+    Serial.print("), ");
+    Serial.print(slot.power_mean);
+    Serial.print(" mW, ");
+    Serial.print(slot.energy_J, 4);
+    Serial.println(" J");
+    from_s = slot.start_s + 1;
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  // Wait until serial port is opened
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println("Adafruit INA228 rollup history, send 'h' to print it");
+
+  if (!ina228.begin()) {
+    Serial.println("Couldn't find INA228 chip");
+    while (1)
+      ;
+  }
+  ina228.setShunt(0.015, 10.0);
+  ina228.setAveragingCount(INA228_COUNT_64);
+}
+
+void loop() {
+  INA228_Snapshot snapshot;
+  if (ina228.conversionReady() &&
+      ina228.readSnapshot(snapshot, INA228_CHANNEL_CURRENT |
+                                        INA228_CHANNEL_POWER |
+                                        INA228_CHANNEL_ENERGY)) {
+    history.add(snapshot);
+  }
+
+  if (Serial.read() == 'h') {
+    Serial.println("Minutes:");
+    printSlots(INA228_ROLLUP_MINUTES, 0);
+    Serial.println("Last 10 seconds:");
+    printSlots(INA228_ROLLUP_SECONDS, history.now() - 10);
+  }
+}
@@ -0,0 +1,70 @@
+// Prints current and bus voltage statistics every ten seconds, without
+// keeping the samples in memory.
+#include <Adafruit_INA228.h>
+#include <Adafruit_INA228_Statistics.h>
+
+#define INTERVAL_MS 10000
+
+Adafruit_INA228 ina228 = Adafruit_INA228();
+INA228_Statistics running =
+    INA228_Statistics(INA228_CHANNEL_CURRENT | INA228_CHANNEL_BUS_VOLTAGE);
+INA228_Statistics interval;
+
+unsigned long interval_start;
+
+void print(const char* name, INA228_Channel channel, const char* unit) {
+  INA228_ChannelStats stats;
+  if (!interval.read(channel, stats)) {
+    return;
+  }
+  Serial.print(name);
+  Serial.print(": mean ");
+  Serial.print(stats.mean, 3);
+  Serial.print(unit);
+  Serial.print(", min ");
+  Serial.print(stats.min, 3);
+  Serial.print(", max ");
+  Serial.print(stats.max, 3);
+  Serial.print(", rms ");
+  Serial.print(stats.rms, 3);
+  Serial.print(", std dev ");
+  Serial.print(sqrt(stats.variance), 3);
+  Serial.print(" over ");
+  Serial.print(stats.count);
+  Serial.println(" samples");
+}
+
+void setup() {
+  Serial.begin(115200);
+  // Wait until serial port is opened
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println("Adafruit INA228 interval statistics");
+
+  if (!ina228.begin()) {
+    Serial.println("Couldn't find INA228 chip");
+    while (1)
+      ;
+  }
+  ina228.setShunt(0.015, 10.0);
+  ina228.setAveragingCount(INA228_COUNT_16);
+  interval_start = millis();
+}
+
+void loop() {
+  INA228_Snapshot snapshot;
+  if (ina228.conversionReady() &&
+      ina228.readSnapshot(snapshot, INA228_CHANNEL_CURRENT |
+                                        INA228_CHANNEL_BUS_VOLTAGE)) {
+    running.add(snapshot);
+  }
+
+  if (millis() - interval_start >= INTERVAL_MS) {
+    interval_start += INTERVAL_MS;
+    running.snapshotAndReset(interval);
+    print("Current", INA228_CHANNEL_CURRENT, " mA");
+    print("Bus    ", INA228_CHANNEL_BUS_VOLTAGE, " V");
+  }
+}
@@ -100,6 +100,7 @@ void loop() {
   // ina228.setMode(INA228_MODE_TRIGGERED);
   // while (!ina228.conversionReady())
   //  delay(1);
+  // see the ina228_triggered example for doing this without blocking
 
   Serial.print("Current: ");
   Serial.print(ina228.getCurrent_mA());
@@ -0,0 +1,52 @@
+// Takes triggered (one shot) measurements without blocking the loop.
+#include <Adafruit_INA228.h>
+
+Adafruit_INA228 ina228 = Adafruit_INA228();
+
+unsigned long loops = 0;
+
+void setup() {
+  Serial.begin(115200);
+  // Wait until serial port is opened
+  while (!Serial) {
+    delay(10);
+  }
+
+  Serial.println("Adafruit INA228 non-blocking triggered mode");
+
+  if (!ina228.begin()) {
+    Serial.println("Couldn't find INA228 chip");
+    while (1)
+      ;
+  }
+  ina228.setShunt(0.015, 10.0);
+  ina228.setAveragingCount(INA228_COUNT_16);
+
+  ina228.startConversion();
+}
+
+void loop() {
+  // poll() returns right away, the loop keeps running other work meanwhile
+  loops++;
+
+  switch (ina228.poll()) {
+  case INA2XX_CONVERSION_READY: {
+    const INA2XX_Measurement& m = ina228.result();
+    Serial.print("Current: ");
+    Serial.print(m.current_mA);
+    Serial.print(" mA, Bus: ");
+    Serial.print(m.bus_voltage_V);
+    Serial.print(" V, loops while waiting: ");
+    Serial.println(loops);
+    loops = 0;
+    ina228.startConversion();
+    break;
+  }
+  case INA2XX_CONVERSION_TIMEOUT:
+    Serial.println("Conversion timed out");
+    ina228.startConversion();
+    break;
+  default:
+    break;
+  }
+}
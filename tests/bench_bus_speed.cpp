@@ -0,0 +1,79 @@
+// Host version of examples/ina228_bus_speed: reads per second at each I2C
+// speed from the modelled bus time, next to achievableSampleRate(), and
+// the host CPU time a readSnapshot() takes on top.
+#include <time.h>
+
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Simulator.h"
+#include "ina228_test.h"
+
+#define SAMPLES 1000 ///< Snapshots read per measurement
+
+static const uint32_t speeds[] = {INA2XX_I2C_STANDARD, INA2XX_I2C_FAST,
+                                  INA2XX_I2C_FAST_PLUS,
+                                  INA2XX_I2C_HIGH_SPEED};
+
+/// A channel set to benchmark
+typedef struct {
+  const char* name; ///< Label in the table
+  uint8_t channels; ///< INA228_Channel bits read
+} ChannelSet;
+
+static const ChannelSet sets[] = {
+    {"CURRENT", INA228_CHANNEL_CURRENT},
+    {"V, I, P", INA228_CHANNEL_BUS_VOLTAGE | INA228_CHANNEL_CURRENT |
+                    INA228_CHANNEL_POWER},
+    {"All", INA228_CHANNEL_ALL}};
+
+static double hostSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+int main(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  ina228.setShunt(0.015, 10.0);
+  // fastest conversions, so the bus is what limits the sample rate
+  ina228.setCurrentConversionTime(INA2XX_TIME_50_us);
+  ina228.setVoltageConversionTime(INA2XX_TIME_50_us);
+  ina228.setTemperatureConversionTime(INA2XX_TIME_50_us);
+  ina228.setAveragingCount(INA2XX_COUNT_1);
+  // serve configuration reads from memory, so only result reads hit the bus
+  CHECK(ina228.enableRegisterCache());
+
+  printf("%9s  %-8s %10s %12s %12s\n", "SCL", "channels", "reads/s",
+         "achievable", "host us/read");
+  for (uint8_t set = 0; set < sizeof(sets) / sizeof(sets[0]); set++) {
+    float last_rate = 0;
+    for (uint8_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+      CHECK(ina228.setBusClock(speeds[i]));
+      INA228_Snapshot snapshot;
+      uint32_t start = bus.busMicros();
+      double host_start = hostSeconds();
+      for (int n = 0; n < SAMPLES; n++) {
+        CHECK(ina228.readSnapshot(snapshot, sets[set].channels));
+      }
+      double host_us = (hostSeconds() - host_start) * 1e6 / SAMPLES;
+      float rate = SAMPLES * 1e6f / (bus.busMicros() - start);
+      float achievable = ina228.achievableSampleRate(sets[set].channels);
+      printf("%5lu kHz  %-8s %10.0f %12.0f %12.2f\n",
+             (unsigned long)(speeds[i] / 1000), sets[set].name, rate,
+             achievable, host_us);
+
+      // a faster clock always reads faster, and the model agrees with the
+      // bus time actually charged or the conversion period, whichever is
+      // slower, within the per-read rounding
+      CHECK(rate > last_rate);
+      float conversion_rate = 1e6f / ina228.conversionPeriodMicros();
+      float limit = rate < conversion_rate ? rate : conversion_rate;
+      CHECK_NEAR(achievable, limit, limit * 0.01);
+      last_rate = rate;
+    }
+  }
+  return testResult();
+}
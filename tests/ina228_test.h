@@ -0,0 +1,100 @@
+/*!
+ *  @file ina228_test.h
+ *
+ * 	Checks and a simulated clock shared by the host tests
+ *
+ *	BSD license (see license.txt)
+ */
+
+#ifndef _INA228_TEST_H
+#define _INA228_TEST_H
+
+#include <math.h>
+#include <stdio.h>
+
+#include "Adafruit_INA228_Simulator.h"
+#include "Adafruit_INA2xx_Platform.h"
+
+static int test_failures = 0; ///< Checks failed so far
+
+/// Records a failure, with the line, if cond is false
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);          \
+      test_failures++;                                                         \
+    }                                                                          \
+  } while (0)
+
+/// Records a failure if a and b are more than tolerance apart
+#define CHECK_NEAR(a, b, tolerance)                                            \
+  do {                                                                         \
+    double _a = (a), _b = (b);                                                 \
+    if (fabs(_a - _b) > (tolerance)) {                                         \
+      printf("%s:%d: %s = %g, expected %g\n", __FILE__, __LINE__, #a, _a,     \
+             _b);                                                              \
+      test_failures++;                                                         \
+    }                                                                          \
+  } while (0)
+
+#define TEST_MAX_SIMULATORS 4 ///< Simulators that can share the clock
+
+static INA228_Simulator* test_simulators[TEST_MAX_SIMULATORS]; ///< Clocked
+static uint8_t test_simulator_count = 0; ///< Entries in test_simulators
+
+/*!
+ *    @brief  Simulated time, as seen through micros()
+ *    @return Time of the first simulator in us
+ */
+static inline uint32_t testMicros(void) {
+  return test_simulators[0]->now();
+}
+
+/*!
+ *    @brief  Moves every simulator on, so a driver that waits for a
+ *            conversion gets it without sleeping
+ *    @param  us
+ *            Time to pass in us
+ */
+static inline void testDelay(uint32_t us) {
+  for (uint8_t i = 0; i < test_simulator_count; i++) {
+    test_simulators[i]->advance(us);
+  }
+}
+
+/*!
+ *    @brief  Runs micros() and delayMicroseconds() on simulated time
+ *    @param  simulator
+ *            The simulator that gives the time, replacing any earlier ones
+ */
+static inline void useSimulatorClock(INA228_Simulator* simulator) {
+  test_simulators[0] = simulator;
+  test_simulator_count = 1;
+  INA2xx_setHostClock(testMicros, testDelay);
+}
+
+/*!
+ *    @brief  Keeps another simulator in step with the first one
+ *    @param  simulator
+ *            The simulator
+ */
+static inline void addSimulatorClock(INA228_Simulator* simulator) {
+  if (test_simulator_count < TEST_MAX_SIMULATORS) {
+    test_simulators[test_simulator_count++] = simulator;
+  }
+}
+
+/*!
+ *    @brief  Reports the outcome, for returning from main()
+ *    @return 0 if every check passed
+ */
+static inline int testResult(void) {
+  if (test_failures) {
+    printf("%d check(s) failed\n", test_failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
+
+#endif
@@ -0,0 +1,114 @@
+// Runs INA228_AccumulatorTracker against the simulator: ENERGY and CHARGE
+// wrapping at 40 bits, and readAndReset() with a working and a failing
+// RSTACC write.
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Accumulator.h"
+#include "Adafruit_INA228_Simulator.h"
+#include "ina228_test.h"
+
+#define ACCUMULATOR_RANGE ((uint64_t)1 << 40) ///< ENERGY and CHARGE wrap
+
+// a simulator transport whose register writes can be made to fail
+class FlakyTransport : public INA228_SimulatorTransport {
+ public:
+  FlakyTransport(INA228_Simulator* simulator)
+      : INA228_SimulatorTransport(simulator), fail_writes(false) {}
+
+  bool write(const uint8_t* buffer, size_t len) override {
+    return !fail_writes && INA228_SimulatorTransport::write(buffer, len);
+  }
+
+  bool fail_writes; ///< NACK every plain write
+};
+
+// a load of 12 V at 100 mA through 15 mohm
+static void setLoad(INA228_Simulator& sim, Adafruit_INA228& ina228) {
+  CHECK(ina228.setShunt(0.015, 10.0));
+  sim.setBusVoltage(12.0);
+  sim.setShuntVoltage(0.0015);
+}
+
+static void testEnergyWrap(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  setLoad(sim, ina228);
+
+  uint64_t start = ACCUMULATOR_RANGE - 500;
+  sim.setRegister(INA228_REG_ENERGY, start);
+  INA228_AccumulatorTracker tracker(&ina228);
+  CHECK(tracker.begin());
+  start = ina228.readEnergyRaw();
+
+  delayMicroseconds(1000000);
+  CHECK(tracker.update());
+  uint64_t now = ina228.readEnergyRaw();
+  CHECK(now < start); // the register wrapped
+  CHECK(tracker.energyWraps() == 1);
+  CHECK(tracker.energyRaw() == now + ACCUMULATOR_RANGE - start);
+}
+
+static void testChargeWrap(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  setLoad(sim, ina228);
+
+  // just below the largest positive 40-bit count
+  sim.setRegister(INA228_REG_CHARGE, ((uint64_t)1 << 39) - 1000);
+  INA228_AccumulatorTracker tracker(&ina228);
+  CHECK(tracker.begin());
+  int64_t start = ina228.readChargeRaw();
+
+  delayMicroseconds(1000000);
+  CHECK(tracker.update());
+  int64_t now = ina228.readChargeRaw();
+  CHECK(now < 0); // wrapped to the most negative counts
+  CHECK(tracker.chargeWraps() == 1);
+  CHECK(tracker.chargeRaw() == now + (int64_t)ACCUMULATOR_RANGE - start);
+  // 100 mA for a second, in current LSBs
+  CHECK_NEAR(tracker.chargeRaw() * (10.0 / 524288), 0.1, 0.001);
+}
+
+static void testReadAndReset(void) {
+  INA228_Simulator sim;
+  FlakyTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  setLoad(sim, ina228);
+  INA228_AccumulatorTracker tracker(&ina228);
+  CHECK(tracker.begin());
+
+  delayMicroseconds(500000);
+  uint64_t energy;
+  int64_t charge;
+  CHECK(tracker.readAndReset(&energy, &charge));
+  CHECK(energy > 0 && charge > 0);
+  CHECK(tracker.energyRaw() == 0 && tracker.chargeRaw() == 0);
+  CHECK(ina228.readEnergyRaw() < energy);
+
+  // the chip keeps counting when RSTACC can't be written
+  delayMicroseconds(500000);
+  bus.fail_writes = true;
+  CHECK(!tracker.readAndReset(&energy, &charge));
+  bus.fail_writes = false;
+  uint64_t kept = tracker.energyRaw();
+  CHECK(kept > 0);
+
+  // so the next update adds only the change, not the whole register again
+  delayMicroseconds(500000);
+  CHECK(tracker.update());
+  CHECK(tracker.energyRaw() == ina228.readEnergyRaw());
+}
+
+int main(void) {
+  testEnergyWrap();
+  testChargeWrap();
+  testReadAndReset();
+  return testResult();
+}
@@ -0,0 +1,89 @@
+// Drives INA228_Acquisition without a pin: each simulated conversion edge
+// calls handleAlert() at the simulator's conversion period, and the test
+// checks the samples read out and the missed conversions counted from the
+// gaps between edges. Also checks the alert types setAlertType() refuses.
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Acquisition.h"
+#include "Adafruit_INA228_Simulator.h"
+#include "ina228_test.h"
+
+// lets count conversions finish, signalling the last one on ALERT
+static void convert(INA228_Simulator& sim, INA228_Acquisition& acquisition,
+                    uint8_t count) {
+  delayMicroseconds(count * sim.conversionPeriod());
+  acquisition.handleAlert();
+}
+
+static void testMissedConversions(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  ina228.setShunt(0.015, 10.0);
+  sim.setBusVoltage(12.0);
+  CHECK(ina228.conversionPeriodMicros() == sim.conversionPeriod());
+
+  INA228_Acquisition acquisition(&ina228);
+  CHECK(acquisition.begin(-1));
+  CHECK(ina228.getAlertType() == INA228_ALERT_CONVERSION_READY);
+
+  // two edges before the first service(): no interval yet, so the older
+  // one counts as superseded
+  convert(sim, acquisition, 1);
+  convert(sim, acquisition, 1);
+  CHECK(acquisition.service() == 1);
+  CHECK(acquisition.missedConversions() == 1);
+
+  // read out every conversion
+  for (uint8_t i = 0; i < 5; i++) {
+    convert(sim, acquisition, 1);
+    CHECK(acquisition.service() == 1);
+  }
+  CHECK(acquisition.missedConversions() == 1);
+
+  // the latched ALERT gives no edge for the two conversions in between
+  convert(sim, acquisition, 3);
+  CHECK(acquisition.service() == 1);
+  CHECK(acquisition.missedConversions() == 3);
+
+  // two edges seen but serviced once: the gap to the newest counts
+  convert(sim, acquisition, 1);
+  convert(sim, acquisition, 1);
+  CHECK(acquisition.service() == 1);
+  CHECK(acquisition.service() == 0);
+  CHECK(acquisition.missedConversions() == 4);
+
+  CHECK(acquisition.available() == 8);
+  INA228_Snapshot snapshot;
+  CHECK(acquisition.read(snapshot));
+  CHECK_NEAR(snapshot.bus_voltage_V, 12.0, 0.001);
+  CHECK(acquisition.overruns() == 0);
+
+  acquisition.clearCounters();
+  CHECK(acquisition.missedConversions() == 0);
+  acquisition.end();
+}
+
+static void testAlertTypes(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+
+  CHECK(ina228.setAlertType(INA228_ALERT_CONVERSION_READY));
+  CHECK(ina228.getAlertType() == INA228_ALERT_CONVERSION_READY);
+  // the limit alerts have no enable bit, CNVR is left alone
+  CHECK(!ina228.setAlertType(INA228_ALERT_OVERPOWER));
+  CHECK(!ina228.setAlertType(INA228_ALERT_OVERCURRENT));
+  CHECK(ina228.getAlertType() == INA228_ALERT_CONVERSION_READY);
+  CHECK(ina228.setAlertType(INA228_ALERT_NONE));
+  CHECK(ina228.getAlertType() == INA228_ALERT_NONE);
+}
+
+int main(void) {
+  testMissedConversions();
+  testAlertTypes();
+  return testResult();
+}
@@ -0,0 +1,211 @@
+// Checks readSnapshotAsync() and INA2xx_FifoScheduler on simulated
+// interrupt-driven transports: queue order, back-to-back pipelining,
+// streaming from the callback and the synchronous fallback.
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Simulator.h"
+#include "Adafruit_INA2xx_Scheduler.h"
+#include "ina228_test.h"
+
+#define POLL_STEP_US 5 ///< Simulated time between scheduler polls
+
+/// What a callback saw, for the checks after the transfers ran
+typedef struct {
+  uint32_t calls;          ///< Callbacks run
+  uint32_t done_at;        ///< Simulated time of the last callback
+  uint32_t resubmit;       ///< Requests the callback still has to make
+  bool ok;                 ///< ok of the last request
+  float current_mA;        ///< Current of the last request
+  Adafruit_INA228* device; ///< Device of the last request
+} Completion;
+
+static INA228_Simulator* clock_source = NULL; ///< Gives done_at
+
+static void onSnapshot(INA228_AsyncSnapshot& request, void* context) {
+  Completion* completion = (Completion*)context;
+  completion->calls++;
+  completion->done_at = clock_source->now();
+  completion->ok = request.ok;
+  completion->current_mA = request.snapshot.current_mA;
+  completion->device = request.device;
+  if (completion->resubmit) {
+    completion->resubmit--;
+    CHECK(request.device->readSnapshotAsync(request, INA228_CHANNEL_CURRENT,
+                                            onSnapshot, context));
+  }
+}
+
+/*!
+ *    @brief  Works out the bus time of a snapshot read
+ *    @param  channels
+ *            INA228_Channel bits read
+ *    @param  clock_hz
+ *            SCL frequency in Hz
+ *    @return Bus time in us
+ */
+static uint32_t snapshotMicros(uint8_t channels, uint32_t clock_hz) {
+  static const uint8_t widths[INA228_SNAPSHOT_REGISTERS] = {3, 3, 2, 3,
+                                                            3, 5, 5};
+  uint8_t buffer[INA228_SNAPSHOT_WIDTH];
+  INA2xx_RegisterRead reads[INA228_SNAPSHOT_REGISTERS];
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < INA228_SNAPSHOT_REGISTERS; i++) {
+    if (channels & (1 << i)) {
+      reads[count].reg = INA2XX_REG_VSHUNT + i;
+      reads[count].len = widths[i];
+      reads[count++].buffer = buffer;
+    }
+  }
+  return INA2xx_Transport::readMicros(reads, count, clock_hz);
+}
+
+static void runUntilIdle(INA2xx_Scheduler& scheduler) {
+  for (uint32_t i = 0; i < 100000 && !scheduler.idle(); i++) {
+    delayMicroseconds(POLL_STEP_US);
+    scheduler.poll();
+  }
+  CHECK(scheduler.idle());
+}
+
+static void setUp(Adafruit_INA228& ina228, INA2xx_Transport* bus,
+                  INA228_Simulator& sim, float shunt_voltage) {
+  CHECK(ina228.begin(bus));
+  ina228.setShunt(0.015, 10.0);
+  // the ADC range comes from the cache, so starting a read never blocks
+  CHECK(ina228.enableRegisterCache());
+  sim.setShuntVoltage(shunt_voltage);
+}
+
+static void testPipelined(void) {
+  INA228_Simulator sim_a(0x40), sim_b(0x41);
+  useSimulatorClock(&sim_a);
+  addSimulatorClock(&sim_b);
+  clock_source = &sim_a;
+  INA228_AsyncSimulatorTransport bus_a(&sim_a), bus_b(&sim_b);
+  Adafruit_INA228 a, b;
+  setUp(a, &bus_a, sim_a, 0.0015);
+  setUp(b, &bus_b, sim_b, -0.0030);
+  delayMicroseconds(sim_a.conversionPeriod());
+
+  INA2xx_FifoScheduler scheduler;
+  a.setScheduler(&scheduler);
+  b.setScheduler(&scheduler);
+  INA228_AsyncSnapshot request_a, request_b;
+  Completion done_a = {}, done_b = {};
+
+  uint32_t start = sim_a.now();
+  CHECK(a.readSnapshotAsync(request_a, INA228_CHANNEL_ALL, onSnapshot,
+                            &done_a));
+  CHECK(b.readSnapshotAsync(request_b, INA228_CHANNEL_ALL, onSnapshot,
+                            &done_b));
+  // a request still in flight can't be reused
+  CHECK(!a.readSnapshotAsync(request_a, INA228_CHANNEL_ALL, onSnapshot,
+                             &done_a));
+  // one transfer on the bus at a time, the second one waits its turn
+  CHECK(request_a.pending() && request_b.pending());
+  CHECK(bus_a.busy() && !bus_b.busy());
+  CHECK(scheduler.inFlight() == 1);
+  CHECK(done_a.calls == 0);
+
+  runUntilIdle(scheduler);
+  CHECK(done_a.calls == 1 && done_b.calls == 1);
+  CHECK(done_a.ok && done_b.ok);
+  CHECK(done_a.device == &a && done_b.device == &b);
+  CHECK_NEAR(done_a.current_mA, 100.0, 0.1);
+  CHECK_NEAR(done_b.current_mA, -200.0, 0.1);
+
+  // each transfer takes its bus time, and b starts as soon as a finished
+  uint32_t transfer_us = snapshotMicros(INA228_CHANNEL_ALL, bus_a.clock());
+  CHECK(done_a.done_at - start >= transfer_us);
+  CHECK(done_a.done_at - start < transfer_us + POLL_STEP_US);
+  CHECK(done_b.done_at - done_a.done_at >= transfer_us);
+  CHECK(done_b.done_at - done_a.done_at < transfer_us + POLL_STEP_US);
+}
+
+static void testStreaming(void) {
+  INA228_Simulator sim;
+  useSimulatorClock(&sim);
+  clock_source = &sim;
+  INA228_AsyncSimulatorTransport bus(&sim, INA2XX_I2C_FAST);
+  Adafruit_INA228 ina228;
+  setUp(ina228, &bus, sim, 0.0015);
+  INA2xx_FifoScheduler scheduler;
+  ina228.setScheduler(&scheduler);
+
+  // the callback queues the next read, so reads follow each other with no
+  // gap but the poll interval
+  INA228_AsyncSnapshot request;
+  Completion done = {};
+  done.resubmit = 9;
+  uint32_t start = sim.now();
+  CHECK(ina228.readSnapshotAsync(request, INA228_CHANNEL_CURRENT, onSnapshot,
+                                 &done));
+  runUntilIdle(scheduler);
+  CHECK(done.calls == 10);
+  uint32_t transfer_us = snapshotMicros(INA228_CHANNEL_CURRENT, bus.clock());
+  CHECK(done.done_at - start >= 10 * transfer_us);
+  CHECK(done.done_at - start < 10 * (transfer_us + POLL_STEP_US));
+}
+
+static void testWithoutScheduler(void) {
+  INA228_Simulator sim;
+  useSimulatorClock(&sim);
+  clock_source = &sim;
+
+  // straight onto an interrupt-driven transport, polled by the caller
+  INA228_AsyncSimulatorTransport async_bus(&sim);
+  Adafruit_INA228 ina228;
+  setUp(ina228, &async_bus, sim, 0.0015);
+  INA228_AsyncSnapshot request;
+  Completion done = {};
+  CHECK(ina228.readSnapshotAsync(request, INA228_CHANNEL_ALL, onSnapshot,
+                                 &done));
+  CHECK(request.pending() && done.calls == 0);
+  for (uint32_t i = 0; i < 1000 && request.pending(); i++) {
+    delayMicroseconds(POLL_STEP_US);
+    async_bus.poll();
+  }
+  CHECK(done.calls == 1 && done.ok);
+
+  // a blocking transport runs the reads and the callback before returning
+  INA228_SimulatorTransport bus(&sim);
+  CHECK(ina228.begin(&bus));
+  done.calls = 0;
+  CHECK(ina228.readSnapshotAsync(request, INA228_CHANNEL_ALL, onSnapshot,
+                                 &done));
+  CHECK(done.calls == 1 && !request.pending());
+}
+
+static void testTwoBuses(void) {
+  INA228_Simulator sim_a(0x40), sim_b(0x40);
+  useSimulatorClock(&sim_a);
+  addSimulatorClock(&sim_b);
+  clock_source = &sim_a;
+  INA228_AsyncSimulatorTransport bus_a(&sim_a), bus_b(&sim_b);
+  Adafruit_INA228 a, b;
+  setUp(a, &bus_a, sim_a, 0.0015);
+  setUp(b, &bus_b, sim_b, 0.0015);
+
+  // with a transfer per bus in flight both reads run side by side
+  INA2xx_FifoScheduler scheduler(2);
+  a.setScheduler(&scheduler);
+  b.setScheduler(&scheduler);
+  INA228_AsyncSnapshot request_a, request_b;
+  Completion done_a = {}, done_b = {};
+  CHECK(a.readSnapshotAsync(request_a, INA228_CHANNEL_ALL, onSnapshot,
+                            &done_a));
+  CHECK(b.readSnapshotAsync(request_b, INA228_CHANNEL_ALL, onSnapshot,
+                            &done_b));
+  CHECK(bus_a.busy() && bus_b.busy());
+  CHECK(scheduler.inFlight() == 2);
+  runUntilIdle(scheduler);
+  CHECK(done_a.calls == 1 && done_b.calls == 1);
+  CHECK(done_a.done_at == done_b.done_at);
+}
+
+int main(void) {
+  testPipelined();
+  testStreaming();
+  testWithoutScheduler();
+  testTwoBuses();
+  return testResult();
+}
@@ -0,0 +1,192 @@
+// Runs Adafruit_INA228 against the register-level simulator: begin(),
+// the float and integer readers, snapshots, triggered conversions, the
+// register cache and the compile-time calibration.
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Calibration.h"
+#include "Adafruit_INA228_Simulator.h"
+#include "ina228_test.h"
+
+static void testBegin(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+
+  sim.setFault(true);
+  CHECK(!ina228.begin(&bus));
+  sim.setFault(false);
+
+  CHECK(ina228.begin(&bus));
+  CHECK(ina228.transport() == &bus);
+  // begin() waited for the first conversion on simulated time
+  CHECK(sim.conversions() >= 1);
+  CHECK(ina228.isReady());
+}
+
+static void testReadings(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  ina228.setShunt(0.015, 10.0);
+
+  sim.setShuntVoltage(0.0015); // 100 mA through 15 mohm
+  sim.setBusVoltage(12.0);
+  sim.setDieTemperature(25.0);
+  delayMicroseconds(sim.conversionPeriod());
+
+  CHECK_NEAR(ina228.readBusVoltage(), 12.0, 0.001);
+  CHECK_NEAR(ina228.readShuntVoltage(), 1.5, 0.001);
+  CHECK_NEAR(ina228.readCurrent(), 100.0, 0.1);
+  CHECK_NEAR(ina228.readPower(), 1200.0, 2.0);
+  CHECK_NEAR(ina228.readDieTemp(), 25.0, 0.01);
+  CHECK_NEAR(ina228.readCurrent_uA(), 100000, 100);
+  CHECK_NEAR((double)ina228.readPower_uW(), 1200000, 2000);
+
+  INA228_Snapshot first, second;
+  CHECK(ina228.readSnapshot(first));
+  CHECK(first.mask == INA228_CHANNEL_ALL);
+  CHECK_NEAR(first.bus_voltage_V, 12.0, 0.001);
+  CHECK_NEAR(first.current_mA, 100.0, 0.1);
+  CHECK(first.timestamp_us == sim.now());
+
+  // the accumulators integrate 1.2 W and 100 mA over a second
+  delayMicroseconds(1000000);
+  CHECK(ina228.readSnapshot(second, INA228_CHANNEL_ENERGY |
+                                        INA228_CHANNEL_CHARGE));
+  CHECK(second.mask == (INA228_CHANNEL_ENERGY | INA228_CHANNEL_CHARGE));
+  CHECK_NEAR(second.energy_J - first.energy_J, 1.2, 0.01);
+  CHECK_NEAR(second.charge_C - first.charge_C, 0.1, 0.001);
+}
+
+static void testTriggered(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  ina228.setShunt(0.015, 10.0);
+  ina228.setAveragingCount(INA2XX_COUNT_16);
+  sim.setBusVoltage(5.0);
+  sim.setShuntVoltage(-0.003);
+
+  // a DIAG_ALRT read after a continuous conversion latches CNVRF on the host
+  delayMicroseconds(sim.conversionPeriod() + 1000);
+  ina228.readLimitEvents();
+  uint32_t start = sim.now();
+  CHECK(ina228.startConversion());
+  CHECK(!ina228.conversionReady());
+  INA2XX_ConversionState state;
+  while ((state = ina228.poll()) == INA2XX_CONVERSION_PENDING) {
+    delayMicroseconds(100);
+  }
+  CHECK(state == INA2XX_CONVERSION_READY);
+  // 16 x 3 x 1052 us, the result is not picked up before it exists
+  CHECK(sim.now() - start >= sim.conversionPeriod());
+  const INA2XX_Measurement& result = ina228.result();
+  CHECK_NEAR(result.bus_voltage_V, 5.0, 0.001);
+  CHECK_NEAR(result.current_mA, -200.0, 0.1);
+  CHECK(ina228.getMode() == INA2XX_MODE_TRIGGERED);
+}
+
+static void testRegisterCache(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  CHECK(ina228.enableRegisterCache());
+
+  ina228.setAveragingCount(INA2XX_COUNT_64);
+  uint32_t transactions = bus.transactions();
+  CHECK(ina228.getAveragingCount() == INA2XX_COUNT_64);
+  CHECK(ina228.getMode() == INA2XX_MODE_CONTINUOUS);
+  CHECK(bus.transactions() == transactions);
+  // the chip holds what the cache says
+  CHECK((sim.getRegister(INA2XX_REG_ADCCFG) & 0x7) == INA2XX_COUNT_64);
+}
+
+// exposes the fixed-point scales setShunt() works out
+class ScaleProbe : public Adafruit_INA228 {
+ public:
+  bool matches(const INA228_Calibration& calibration) {
+    return sameScale(_current_scale, calibration.current_scale) &&
+           sameScale(_power_scale, calibration.power_scale) &&
+           sameScale(_energy_scale, calibration.energy_scale) &&
+           sameScale(_charge_scale, calibration.charge_scale);
+  }
+
+  // relative error of the current multiplier against the LSB in uA
+  double currentScaleError(void) {
+    double exact = (double)getCurrentLSB() * 1e6;
+    return fabs(ldexp(_current_scale.mult, -_current_scale.shift) / exact - 1);
+  }
+
+ private:
+  static bool sameScale(const INA2XX_FixedScale& a,
+                        const INA2XX_FixedScale& b) {
+    return a.mult == b.mult && a.shift == b.shift;
+  }
+};
+
+static void testCalibration(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  ScaleProbe ina228;
+  CHECK(ina228.begin(&bus));
+
+  // the constexpr scales match, also for LSBs that a float rounds
+  ina228.setShunt(0.1, 5.0);
+  CHECK(ina228.matches(INA228_Calibration(0.1, 5.0)));
+  ina228.setShunt(0.015, 0.7);
+  CHECK(ina228.matches(INA228_Calibration(0.015, 0.7)));
+  // the multiplier uses its 32 bits, not just the 24 of a float
+  CHECK(ina228.currentScaleError() < 1e-9);
+}
+
+// one row of the SHUNT_CAL grid, built by the compiler
+#define CAL_ROW(shunt, range)                                                  \
+  INA228_Calibration(shunt, 0.1, range),                                       \
+      INA228_Calibration(shunt, 1.0, range),                                   \
+      INA228_Calibration(shunt, 3.2, range),                                   \
+      INA228_Calibration(shunt, 15.0, range),                                  \
+      INA228_Calibration(shunt, 40.0, range)
+
+static constexpr INA228_Calibration cal_grid[] = {
+    CAL_ROW(0.0005, 0), CAL_ROW(0.002, 0), CAL_ROW(0.015, 0),
+    CAL_ROW(0.1, 0),    CAL_ROW(2.0, 0),   CAL_ROW(0.0005, 1),
+    CAL_ROW(0.015, 1),  CAL_ROW(0.1, 1)};
+
+static void testShuntCal(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+
+  for (uint8_t i = 0; i < sizeof(cal_grid) / sizeof(cal_grid[0]); i++) {
+    const INA228_Calibration& cal = cal_grid[i];
+    ina228.setADCRange(cal.adc_range);
+    float max_current = cal.current_lsb * 524288;
+    CHECK(ina228.setShunt(cal.shunt_res, max_current) == cal.fits());
+    CHECK(sim.getRegister(INA2XX_REG_SHUNTCAL) == cal.shunt_cal);
+  }
+
+  // rounded to nearest, not truncated: 187.5 and 12.5
+  CHECK(cal_grid[3].shunt_cal == 188);
+  CHECK(cal_grid[1].shunt_cal == 13);
+  // 2 ohm at 40 A is far past the 15-bit field, clamped and reported
+  CHECK(cal_grid[24].shunt_cal == 0x7FFF && !cal_grid[24].fits());
+}
+
+int main(void) {
+  testBegin();
+  testReadings();
+  testTriggered();
+  testRegisterCache();
+  testCalibration();
+  testShuntCal();
+  return testResult();
+}
@@ -0,0 +1,165 @@
+// Runs Adafruit_INA228 through INA2xx_LinuxTransport with open(), ioctl()
+// and close() wrapped at link time, so every I2C_RDWR call lands on the
+// simulator instead of /dev/i2c-N.
+#include <errno.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Simulator.h"
+#include "Adafruit_INA2xx_LinuxTransport.h"
+#include "ina228_test.h"
+
+#define MOCK_DEVICE "/dev/i2c-mock" ///< Adapter path the mock answers to
+#define MOCK_FD 1000                ///< File descriptor of the mock adapter
+
+static INA228_Simulator* mock_device = NULL; ///< Device on the mock bus
+static unsigned long mock_funcs = I2C_FUNC_I2C; ///< Reported by I2C_FUNCS
+static uint32_t mock_rdwr_calls = 0;            ///< I2C_RDWR calls seen
+static uint32_t mock_last_nmsgs = 0; ///< Messages in the last I2C_RDWR
+
+extern "C" {
+int __real_open(const char* path, int flags, ...);
+int __real_close(int fd);
+int __real_ioctl(int fd, unsigned long request, ...);
+
+int __wrap_open(const char* path, int flags, ...) {
+  if (!strcmp(path, MOCK_DEVICE)) {
+    return MOCK_FD;
+  }
+  va_list args;
+  va_start(args, flags);
+  int mode = va_arg(args, int);
+  va_end(args);
+  return __real_open(path, flags, mode);
+}
+
+int __wrap_close(int fd) {
+  return fd == MOCK_FD ? 0 : __real_close(fd);
+}
+
+int __wrap_ioctl(int fd, unsigned long request, ...) {
+  va_list args;
+  va_start(args, request);
+  void* arg = va_arg(args, void*);
+  va_end(args);
+  if (fd != MOCK_FD) {
+    return __real_ioctl(fd, request, arg);
+  }
+  if (request == I2C_FUNCS) {
+    *(unsigned long*)arg = mock_funcs;
+    return 0;
+  }
+  if (request != I2C_RDWR) {
+    errno = ENOTTY;
+    return -1;
+  }
+  struct i2c_rdwr_ioctl_data* data = (struct i2c_rdwr_ioctl_data*)arg;
+  mock_rdwr_calls++;
+  mock_last_nmsgs = data->nmsgs;
+  for (uint32_t i = 0; i < data->nmsgs; i++) {
+    struct i2c_msg& msg = data->msgs[i];
+    bool ok = msg.addr == mock_device->address() &&
+              (msg.flags & I2C_M_RD ? mock_device->read(msg.buf, msg.len)
+                                    : mock_device->write(msg.buf, msg.len));
+    if (!ok) {
+      // the kernel fails the whole transfer on a NACK
+      errno = ENXIO;
+      return -1;
+    }
+  }
+  return data->nmsgs;
+}
+}
+
+static void testOpen(void) {
+  INA228_Simulator sim;
+  mock_device = &sim;
+
+  INA2xx_LinuxTransport missing("/dev/i2c-does-not-exist");
+  CHECK(!missing.begin());
+
+  mock_funcs = 0; // an SMBus-only adapter can't do combined transfers
+  INA2xx_LinuxTransport smbus(MOCK_DEVICE);
+  CHECK(!smbus.begin());
+  mock_funcs = I2C_FUNC_I2C;
+  CHECK(smbus.begin());
+
+  // nothing answers at 0x41
+  INA2xx_LinuxTransport absent(MOCK_DEVICE, 0x41);
+  Adafruit_INA228 ina228;
+  useSimulatorClock(&sim);
+  CHECK(!ina228.begin(&absent));
+}
+
+static void testDriver(void) {
+  INA228_Simulator sim;
+  mock_device = &sim;
+  useSimulatorClock(&sim);
+  INA2xx_LinuxTransport bus(MOCK_DEVICE);
+  Adafruit_INA228 ina228;
+  // the adapter sets its own clock, so begin() drops the one asked for
+  CHECK(ina228.setBusClock(INA2XX_I2C_FAST_PLUS));
+  CHECK(ina228.begin(&bus));
+  CHECK(ina228.busClock() == INA2XX_I2C_STANDARD);
+  CHECK(!ina228.setBusClock(INA2XX_I2C_FAST_PLUS));
+  CHECK(bus.address() == 0x40);
+  ina228.setShunt(0.015, 10.0);
+
+  sim.setShuntVoltage(0.0015);
+  sim.setBusVoltage(3.3);
+  delayMicroseconds(sim.conversionPeriod());
+  CHECK_NEAR(ina228.readBusVoltage(), 3.3, 0.001);
+  CHECK_NEAR(ina228.readCurrent(), 100.0, 0.1);
+
+  // a register read is one ioctl: pointer write and read, repeated start
+  uint32_t calls = mock_rdwr_calls;
+  CHECK(ina228.readBusVoltageRaw() > 0);
+  CHECK(mock_rdwr_calls == calls + 1 && mock_last_nmsgs == 2);
+
+  // a full snapshot is seven register reads in a single syscall, with the
+  // ADC range taken from the register cache
+  CHECK(ina228.enableRegisterCache());
+  INA228_Snapshot snapshot;
+  calls = bus.syscalls();
+  CHECK(ina228.readSnapshot(snapshot));
+  CHECK(bus.syscalls() == calls + 1);
+  CHECK(mock_last_nmsgs == 2 * INA228_SNAPSHOT_REGISTERS);
+  CHECK_NEAR(snapshot.bus_voltage_V, 3.3, 0.001);
+  CHECK_NEAR(snapshot.current_mA, 100.0, 0.1);
+}
+
+static void testBatching(void) {
+  INA228_Simulator sim;
+  mock_device = &sim;
+  INA2xx_LinuxTransport bus(MOCK_DEVICE);
+  CHECK(bus.begin());
+
+  // more reads than one I2C_RDWR takes are split into batches
+  const uint8_t count = INA2XX_LINUX_MAX_BATCH + 5;
+  uint8_t buffers[count][2];
+  INA2xx_RegisterRead reads[count];
+  for (uint8_t i = 0; i < count; i++) {
+    reads[i].reg = i % 2 ? INA2XX_REG_MFG_UID : INA2XX_REG_DVC_UID;
+    reads[i].len = 2;
+    reads[i].buffer = buffers[i];
+  }
+  uint32_t calls = bus.syscalls();
+  CHECK(bus.readRegisters(reads, count));
+  CHECK(bus.syscalls() == calls + 2);
+  CHECK(mock_last_nmsgs == 2 * 5);
+  CHECK(buffers[1][0] == 0x54 && buffers[1][1] == 0x49);
+  CHECK(buffers[count - 1][0] == 0x54);
+
+  bus.end();
+  CHECK(!bus.readRegisters(reads, 1));
+}
+
+int main(void) {
+  testOpen();
+  testDriver();
+  testBatching();
+  return testResult();
+}
@@ -0,0 +1,137 @@
+// Encodes simulator snapshots into the binary log and decodes them back:
+// a full round trip, a reader that joins mid-stream, a damaged keyframe
+// and the size of a typical frame.
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_LogDecoder.h"
+#include "Adafruit_INA228_LogEncoder.h"
+#include "Adafruit_INA228_Simulator.h"
+#include "ina228_test.h"
+
+#define LOG_SNAPSHOTS 1200 ///< Snapshots encoded per test
+#define LOG_INTERVAL 16    ///< Frames from one keyframe to the next
+
+static uint8_t log_bytes[LOG_SNAPSHOTS * INA228_LOG_MAX_FRAME];
+static size_t log_len;
+static size_t frame_start[LOG_SNAPSHOTS]; ///< Offset of each frame
+static INA228_Snapshot snapshots[LOG_SNAPSHOTS];
+
+// logs a load that ramps up and down, sampled once per conversion
+static void makeLog(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  ina228.setShunt(0.015, 10.0);
+  sim.setBusVoltage(12.0);
+
+  INA228_LogEncoder encoder(INA228_CHANNEL_ALL, LOG_INTERVAL);
+  log_len = encoder.header(ina228, log_bytes);
+  for (uint16_t i = 0; i < LOG_SNAPSHOTS; i++) {
+    sim.setShuntVoltage(0.001 + 0.0005 * ((i / 50) % 2 ? 1 : -1));
+    delayMicroseconds(sim.conversionPeriod());
+    CHECK(ina228.readSnapshot(snapshots[i]));
+    frame_start[i] = log_len;
+    uint8_t len = encoder.encode(snapshots[i], log_bytes + log_len);
+    CHECK(len > 0 && len <= INA228_LOG_MAX_FRAME);
+    log_len += len;
+  }
+  CHECK(encoder.frames() == LOG_SNAPSHOTS);
+}
+
+static bool sameRaw(const INA228_LogRecord& record,
+                    const INA228_Snapshot& snapshot) {
+  return record.timestamp_us == snapshot.timestamp_us &&
+         record.shunt_voltage_raw == snapshot.shunt_voltage_raw &&
+         record.bus_voltage_raw == snapshot.bus_voltage_raw &&
+         record.die_temp_raw == snapshot.die_temp_raw &&
+         record.current_raw == snapshot.current_raw &&
+         record.power_raw == snapshot.power_raw &&
+         record.energy_raw == snapshot.energy_raw &&
+         record.charge_raw == snapshot.charge_raw;
+}
+
+// decodes log_bytes from offset on, returns the index of the first
+// snapshot decoded or -1, and checks every record against its snapshot
+static int32_t decodeFrom(size_t offset, uint32_t* decoded) {
+  INA228_LogDecoder decoder;
+  INA228_LogRecord record;
+  int32_t first = -1;
+  uint16_t next = 0;
+  *decoded = 0;
+  while (offset < log_len) {
+    size_t used;
+    INA228_LogStatus status =
+        decoder.decode(log_bytes + offset, log_len - offset, used, record);
+    if (status == INA228_LOG_MORE) {
+      break;
+    }
+    if (status == INA228_LOG_RECORD) {
+      // a repeated header sits in front of its keyframe, in the same slot
+      while (next + 1 < LOG_SNAPSHOTS && frame_start[next + 1] <= offset) {
+        next++;
+      }
+      CHECK(sameRaw(record, snapshots[next]));
+      if (first < 0) {
+        first = next;
+      }
+      (*decoded)++;
+    }
+    offset += used;
+  }
+  return first;
+}
+
+static void testRoundTrip(void) {
+  uint32_t decoded;
+  CHECK(decodeFrom(0, &decoded) == 0);
+  CHECK(decoded == LOG_SNAPSHOTS);
+
+  INA228_LogDecoder decoder;
+  INA228_LogRecord record;
+  size_t used;
+  CHECK(decoder.decode(log_bytes, log_len, used, record) ==
+        INA228_LOG_CONFIG);
+  CHECK(decoder.channels() == INA228_CHANNEL_ALL);
+  CHECK_NEAR(decoder.currentLSB(), 10.0 / 524288, 1e-9);
+  CHECK(decoder.decode(log_bytes + used, log_len - used, used, record) ==
+        INA228_LOG_RECORD);
+  CHECK_NEAR(record.bus_voltage_V, 12.0, 0.001);
+  CHECK_NEAR(record.current_mA, snapshots[0].current_mA, 0.01);
+  CHECK_NEAR(record.energy_J, snapshots[0].energy_J, 1e-6);
+}
+
+static void testMidStream(void) {
+  // join a third of the way in, long after the leading header
+  uint32_t decoded;
+  int32_t first = decodeFrom(frame_start[LOG_SNAPSHOTS / 3] + 1, &decoded);
+  CHECK(first > LOG_SNAPSHOTS / 3);
+  // the header comes back within INA228_LOG_HEADER_REPEAT keyframes
+  CHECK(first <= LOG_SNAPSHOTS / 3 + INA228_LOG_HEADER_REPEAT * LOG_INTERVAL);
+  CHECK(decoded == (uint32_t)(LOG_SNAPSHOTS - first));
+}
+
+static void testDamagedKeyframe(void) {
+  // corrupt the keyframe just after the header that opens the log
+  uint8_t saved = log_bytes[frame_start[0] + 2];
+  log_bytes[frame_start[0] + 2] ^= 0x40;
+  uint32_t decoded;
+  int32_t first = decodeFrom(0, &decoded);
+  log_bytes[frame_start[0] + 2] = saved;
+  CHECK(first == LOG_INTERVAL);
+  CHECK(decoded == LOG_SNAPSHOTS - LOG_INTERVAL);
+}
+
+static void testSize(void) {
+  // seven channels of a 20-bit sensor take 29 bytes raw
+  CHECK(log_len < LOG_SNAPSHOTS * 16);
+}
+
+int main(void) {
+  makeLog();
+  testRoundTrip();
+  testMidStream();
+  testDamagedKeyframe();
+  testSize();
+  return testResult();
+}
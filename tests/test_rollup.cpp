@@ -0,0 +1,110 @@
+// Feeds INA228_Rollup one reading a second for three hours and checks
+// where the second, minute and hour slots close, that full tiers drop
+// their oldest slot, query() ranges, and energy taken from an ENERGY
+// register that is reset along the way.
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Rollup.h"
+#include "ina228_test.h"
+
+#define ROLLUP_RUN_S 10800 ///< Three hours, past the micros() wrap
+
+// a reading at t seconds: current cycles through 0, 1 and 2 mA at 1 W
+static INA228_Snapshot reading(uint32_t t) {
+  INA228_Snapshot snapshot;
+  snapshot.mask = INA228_CHANNEL_CURRENT | INA228_CHANNEL_POWER;
+  snapshot.timestamp_us = t * 1000000UL; // wraps like micros()
+  snapshot.current_mA = (float)(t % 3);
+  snapshot.power_mW = 1000.0;
+  return snapshot;
+}
+
+static void testTiers(void) {
+  INA228_Rollup<4, 3, 2> rollup;
+  for (uint32_t t = 0; t <= ROLLUP_RUN_S; t++) {
+    rollup.add(reading(t));
+    if (t == 59) {
+      // the first minute is still open, only the seconds tier closed
+      CHECK(rollup.count(INA228_ROLLUP_SECONDS) == 4);
+      CHECK(rollup.count(INA228_ROLLUP_MINUTES) == 0);
+    } else if (t == 60) {
+      CHECK(rollup.count(INA228_ROLLUP_MINUTES) == 1);
+      CHECK(rollup.count(INA228_ROLLUP_HOURS) == 0);
+    } else if (t == 3600) {
+      CHECK(rollup.count(INA228_ROLLUP_HOURS) == 1);
+    }
+  }
+  CHECK(rollup.now() == ROLLUP_RUN_S);
+
+  // every tier is full, so each kept only its newest slots
+  INA228_RollupSlot slots[4];
+  CHECK(rollup.query(INA228_ROLLUP_SECONDS, 0, ROLLUP_RUN_S, slots, 4) == 4);
+  CHECK(slots[0].start_s == ROLLUP_RUN_S - 4);
+  CHECK(slots[3].start_s == ROLLUP_RUN_S - 1);
+  CHECK(slots[3].count == 1);
+  CHECK_NEAR(slots[3].energy_J, 1.0, 1e-4);
+
+  CHECK(rollup.query(INA228_ROLLUP_MINUTES, 0, ROLLUP_RUN_S, slots, 4) == 3);
+  CHECK(slots[0].start_s == ROLLUP_RUN_S - 180);
+  CHECK(slots[2].start_s == ROLLUP_RUN_S - 60);
+  CHECK(slots[2].count == 60);
+  CHECK(slots[2].current_min == 0 && slots[2].current_max == 2);
+  CHECK_NEAR(slots[2].current_mean, 1.0, 1e-4);
+  CHECK_NEAR(slots[2].energy_J, 60.0, 1e-3);
+
+  // the first hour was overwritten
+  CHECK(rollup.query(INA228_ROLLUP_HOURS, 0, ROLLUP_RUN_S, slots, 4) == 2);
+  CHECK(slots[0].start_s == 3600 && slots[1].start_s == 7200);
+  CHECK(slots[1].count == 3600);
+  CHECK_NEAR(slots[1].energy_J, 3600.0, 0.1);
+  CHECK_NEAR(slots[1].power_mean, 1000.0, 0.01);
+
+  // the reading at 3 h opened a slot in every tier
+  CHECK(rollup.openSlot(INA228_ROLLUP_HOURS).start_s == ROLLUP_RUN_S);
+  CHECK(rollup.openSlot(INA228_ROLLUP_HOURS).count == 1);
+}
+
+static void testQuery(void) {
+  INA228_Rollup<8, 2, 2> rollup;
+  rollup.setTime(100); // the first reading is at 100 s on this clock
+  for (uint32_t t = 100; t <= 108; t++) {
+    rollup.add(reading(t));
+  }
+  INA228_RollupSlot slots[8];
+  // from_s is included, to_s is not
+  CHECK(rollup.query(INA228_ROLLUP_SECONDS, 102, 105, slots, 8) == 3);
+  CHECK(slots[0].start_s == 102 && slots[2].start_s == 104);
+  // max keeps the oldest matches
+  CHECK(rollup.query(INA228_ROLLUP_SECONDS, 0, 200, slots, 2) == 2);
+  CHECK(slots[0].start_s == 100 && slots[1].start_s == 101);
+  CHECK(rollup.query(INA228_ROLLUP_SECONDS, 200, 300, slots, 8) == 0);
+  // the open slot is not returned
+  CHECK(rollup.query(INA228_ROLLUP_SECONDS, 108, 109, slots, 8) == 0);
+
+  rollup.clear();
+  CHECK(rollup.count(INA228_ROLLUP_SECONDS) == 0);
+  CHECK(rollup.openSlot(INA228_ROLLUP_SECONDS).count == 0);
+  CHECK(rollup.now() == 108);
+}
+
+static void testEnergyRegister(void) {
+  INA228_Rollup<> rollup;
+  // 1 mJ per ENERGY LSB; the register is reset between 3000 and 500
+  const uint64_t energy[] = {1000, 3000, 500, 1500};
+  for (uint8_t i = 0; i < 4; i++) {
+    INA228_Snapshot snapshot = reading(i);
+    snapshot.mask |= INA228_CHANNEL_ENERGY;
+    snapshot.energy_raw = energy[i];
+    snapshot.energy_J = energy[i] * 0.001;
+    rollup.add(snapshot);
+  }
+  // 2 J, then 0.5 J counted from the reset, then 1 J. The power would
+  // have given 3 J.
+  CHECK_NEAR(rollup.openSlot(INA228_ROLLUP_HOURS).energy_J, 3.5, 1e-4);
+}
+
+int main(void) {
+  testTiers();
+  testQuery();
+  testEnergyRegister();
+  return testResult();
+}
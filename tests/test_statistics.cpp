@@ -0,0 +1,112 @@
+// Checks INA228_Statistics: count, min, max, mean, variance and rms of a
+// known series, channels left out of the mask, snapshots with timestamps
+// and ending an interval with snapshotAndReset().
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Simulator.h"
+#include "Adafruit_INA228_Statistics.h"
+#include "ina228_test.h"
+
+// mean 5, population variance 4, mean square 29
+static const float series[] = {2, 4, 4, 4, 5, 5, 7, 9};
+#define SERIES_LEN (sizeof(series) / sizeof(series[0])) ///< Samples
+
+static void testSeries(void) {
+  INA228_Statistics statistics;
+  INA228_ChannelStats stats;
+  CHECK(!statistics.read(INA228_CHANNEL_CURRENT, stats));
+  CHECK(stats.count == 0 && stats.mean == 0 && stats.rms == 0);
+
+  for (uint8_t i = 0; i < SERIES_LEN; i++) {
+    statistics.add(INA228_CHANNEL_CURRENT, series[i]);
+    statistics.add(INA228_CHANNEL_POWER, -series[i]);
+  }
+  CHECK(statistics.count(INA228_CHANNEL_CURRENT) == SERIES_LEN);
+  CHECK(statistics.read(INA228_CHANNEL_CURRENT, stats));
+  CHECK(stats.count == SERIES_LEN);
+  CHECK(stats.min == 2 && stats.max == 9);
+  CHECK_NEAR(stats.mean, 5.0, 1e-6);
+  CHECK_NEAR(stats.variance, 4.0, 1e-5);
+  CHECK_NEAR(stats.rms, sqrt(29.0), 1e-5);
+
+  // the rms of a negative channel is its magnitude
+  CHECK(statistics.read(INA228_CHANNEL_POWER, stats));
+  CHECK(stats.min == -9 && stats.max == -2);
+  CHECK_NEAR(stats.mean, -5.0, 1e-6);
+  CHECK_NEAR(stats.rms, sqrt(29.0), 1e-5);
+
+  // single values carry no timestamp, and other channels stay empty
+  CHECK(statistics.firstTimestamp() == 0 && statistics.lastTimestamp() == 0);
+  CHECK(!statistics.read(INA228_CHANNEL_BUS_VOLTAGE, stats));
+  // ENERGY and CHARGE have no statistics
+  CHECK(!statistics.read(INA228_CHANNEL_ENERGY, stats));
+}
+
+static void testMask(void) {
+  INA228_Statistics statistics(INA228_CHANNEL_BUS_VOLTAGE);
+  statistics.add(INA228_CHANNEL_CURRENT, 1.0);
+  statistics.add(INA228_CHANNEL_BUS_VOLTAGE, 3.3);
+  INA228_ChannelStats stats;
+  CHECK(!statistics.read(INA228_CHANNEL_CURRENT, stats));
+  CHECK(statistics.count(INA228_CHANNEL_CURRENT) == 0);
+  CHECK(statistics.read(INA228_CHANNEL_BUS_VOLTAGE, stats));
+  CHECK(stats.count == 1 && stats.variance == 0);
+  CHECK_NEAR(stats.rms, 3.3, 1e-6);
+}
+
+static void testSnapshotAndReset(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  ina228.setShunt(0.015, 10.0);
+  sim.setBusVoltage(12.0);
+
+  // 50 mA, then 150 mA, then the next interval at 100 mA
+  INA228_Statistics statistics;
+  INA228_Snapshot snapshot;
+  uint32_t first = 0;
+  for (uint8_t i = 0; i < 10; i++) {
+    sim.setShuntVoltage(i < 5 ? 0.00075 : 0.00225);
+    delayMicroseconds(sim.conversionPeriod());
+    CHECK(ina228.readSnapshot(snapshot));
+    statistics.add(snapshot);
+    if (!i) {
+      first = snapshot.timestamp_us;
+    }
+  }
+  INA228_Statistics interval;
+  statistics.snapshotAndReset(interval);
+
+  INA228_ChannelStats stats;
+  CHECK(interval.read(INA228_CHANNEL_CURRENT, stats));
+  CHECK(stats.count == 10);
+  CHECK_NEAR(stats.min, 50.0, 0.1);
+  CHECK_NEAR(stats.max, 150.0, 0.1);
+  CHECK_NEAR(stats.mean, 100.0, 0.1);
+  CHECK_NEAR(stats.variance, 2500.0, 5.0);
+  CHECK(interval.count(INA228_CHANNEL_BUS_VOLTAGE) == 10);
+  CHECK(interval.firstTimestamp() == first);
+  CHECK(interval.lastTimestamp() == snapshot.timestamp_us);
+
+  // the running statistics start over
+  CHECK(!statistics.read(INA228_CHANNEL_CURRENT, stats));
+  CHECK(statistics.firstTimestamp() == 0);
+  sim.setShuntVoltage(0.0015);
+  delayMicroseconds(sim.conversionPeriod());
+  CHECK(ina228.readSnapshot(snapshot));
+  statistics.add(snapshot);
+  CHECK(statistics.read(INA228_CHANNEL_CURRENT, stats));
+  CHECK(stats.count == 1);
+  CHECK_NEAR(stats.mean, 100.0, 0.1);
+  CHECK(statistics.firstTimestamp() == snapshot.timestamp_us);
+  // and the interval copy is unchanged
+  CHECK(interval.count(INA228_CHANNEL_CURRENT) == 10);
+}
+
+int main(void) {
+  testSeries();
+  testMask();
+  testSnapshotAndReset();
+  return testResult();
+}
@@ -0,0 +1,79 @@
+// Runs the driver built with INA2XX_ENABLE_STATS: each public reader is
+// charged as one call of its own operation, and operations that were never
+// called report zero. A snapshot batch counts a transaction per register.
+#include "Adafruit_INA228.h"
+#include "Adafruit_INA228_Simulator.h"
+#include "ina228_test.h"
+
+static void testUnused(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+
+  ina228.resetStats();
+  const INA2XX_OpStats& stats = ina228.stats(INA2XX_OP_CHARGE);
+  CHECK(stats.calls == 0);
+  CHECK(stats.min_latency_us == 0);
+  CHECK(stats.max_latency_us == 0);
+}
+
+static void testReaders(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  ina228.setShunt(0.015, 10.0);
+  ina228.resetStats();
+
+  // the range lookup is charged to the shunt voltage read, not to CONFIG
+  ina228.readShuntVoltage();
+  const INA2XX_OpStats& shunt = ina228.stats(INA2XX_OP_SHUNT_VOLTAGE);
+  CHECK(shunt.calls == 1);
+  CHECK(shunt.transactions == 2);
+  CHECK(ina228.stats(INA2XX_OP_CONFIG).transactions == 0);
+  CHECK(shunt.min_latency_us <= shunt.max_latency_us);
+
+  ina228.readBusVoltage();
+  ina228.readCurrent();
+  ina228.readCurrent_uA();
+  ina228.readPower();
+  ina228.readDieTemp();
+  ina228.readEnergy();
+  ina228.readCharge_uC();
+  CHECK(ina228.stats(INA2XX_OP_BUS_VOLTAGE).calls == 1);
+  CHECK(ina228.stats(INA2XX_OP_CURRENT).calls == 2);
+  CHECK(ina228.stats(INA2XX_OP_POWER).calls == 1);
+  CHECK(ina228.stats(INA2XX_OP_DIE_TEMP).calls == 1);
+  CHECK(ina228.stats(INA2XX_OP_ENERGY).calls == 1);
+  CHECK(ina228.stats(INA2XX_OP_CHARGE).calls == 1);
+  CHECK(ina228.stats(INA2XX_OP_CONFIG).calls == 0);
+}
+
+static void testSnapshot(void) {
+  INA228_Simulator sim;
+  INA228_SimulatorTransport bus(&sim);
+  useSimulatorClock(&sim);
+  Adafruit_INA228 ina228;
+  CHECK(ina228.begin(&bus));
+  ina228.setShunt(0.015, 10.0);
+  CHECK(ina228.enableRegisterCache());
+  ina228.resetStats();
+
+  // one batch, but a transaction for each register read in it
+  INA228_Snapshot snapshot;
+  CHECK(ina228.readSnapshot(snapshot));
+  const INA2XX_OpStats& stats = ina228.stats(INA2XX_OP_SNAPSHOT);
+  CHECK(stats.calls == 1);
+  CHECK(stats.transactions == INA228_SNAPSHOT_REGISTERS);
+  CHECK(stats.failures == 0);
+}
+
+int main(void) {
+  testUnused();
+  testReaders();
+  testSnapshot();
+  return testResult();
+}